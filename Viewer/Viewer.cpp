@@ -1,12 +1,15 @@
 #include "Viewer.hpp"
 #include "Utils.hpp"
 
+#include "MyLogger/Strategies/Formatters/Binary/BinaryLogConverter.hpp"
+
 #include "imgui_stdlib.h"
 
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
 #include <limits>
 #include <sstream>
 
@@ -348,173 +351,226 @@ bool TimelineViewer::passesFilters(const Span& p_span) const
 }
 
 // --------------------------------------------------------------------------
-std::string TimelineViewer::loadFromJSON(const std::string& p_json_data)
+Trace TimelineViewer::parseTrace(const nlohmann::json& p_trace_data)
 {
-    nlohmann::json root;
+    Trace trace;
+    trace.trace_id = p_trace_data["traceID"];
+    trace.trace_name = p_trace_data["traceName"];
 
-    try
+    // Check if spans array exists and handle missing spans gracefully
+    if (p_trace_data.contains("spans") && p_trace_data["spans"].is_array())
     {
-        root = nlohmann::json::parse(p_json_data);
-        m_traces.clear();
+        trace.total_spans = p_trace_data["spans"].size();
+    }
+    else
+    {
+        trace.total_spans = 0;
+    }
 
-        for (const auto& trace_data : root["traces"])
-        {
-            Trace trace;
-            trace.trace_id = trace_data["traceID"];
-            trace.trace_name = trace_data["traceName"];
+    // Initialize min/max values
+    double min_time = std::numeric_limits<double>::max();
+    double max_time = 0;
+    trace.min_duration = std::numeric_limits<double>::max();
+    trace.max_duration = 0.0;
+    trace.min_start_time = std::numeric_limits<double>::max();
+    trace.max_start_time = std::numeric_limits<double>::lowest();
 
-            // Check if spans array exists and handle missing spans gracefully
-            if (trace_data.contains("spans") && trace_data["spans"].is_array())
+    // Only process spans if they exist
+    if (p_trace_data.contains("spans") && p_trace_data["spans"].is_array())
+    {
+        for (const auto& span_data : p_trace_data["spans"])
+        {
+            Span span;
+            span.span_id = span_data["spanID"];
+            if (span_data.contains("parentSpanID"))
             {
-                trace.total_spans = trace_data["spans"].size();
+                span.parent_span_id = span_data["parentSpanID"];
+            }
+            span.operation_name = span_data["operationName"];
+            span.service_name = span_data["serviceName"];
+            span.color = serviceToColor(span.service_name);
+            // Keep timestamps in nanoseconds (original OpenTelemetry
+            // format) Time unit conversion will be handled by display
+            // functions
+            span.start_time = span_data["startTime"].get<double>();
+            span.duration = span_data["duration"].get<double>();
+            if (span_data.contains("depth"))
+            {
+                span.depth = span_data["depth"];
             }
             else
             {
-                trace.total_spans = 0;
+                span.depth = 0;
             }
 
-            // Initialize min/max values
-            double min_time = std::numeric_limits<double>::max();
-            double max_time = 0;
-            trace.min_duration = std::numeric_limits<double>::max();
-            trace.max_duration = 0.0;
-            trace.min_start_time = std::numeric_limits<double>::max();
-            trace.max_start_time = std::numeric_limits<double>::lowest();
+            // Tags (test.json format)
+            if (span_data.contains("tags"))
+            {
+                for (const auto& tag : span_data["tags"])
+                {
+                    span.tags.emplace_back(tag["key"], tag["value"]);
+                }
+            }
 
-            // Only process spans if they exist
-            if (trace_data.contains("spans") && trace_data["spans"].is_array())
+            // Attributes (nested-traces.json format)
+            if (span_data.contains("attributes"))
             {
-                for (const auto& span_data : trace_data["spans"])
+                for (const auto& [key, value] :
+                     span_data["attributes"].items())
                 {
-                    Span span;
-                    span.span_id = span_data["spanID"];
-                    span.operation_name = span_data["operationName"];
-                    span.service_name = span_data["serviceName"];
-                    span.color = serviceToColor(span.service_name);
-                    // Keep timestamps in nanoseconds (original OpenTelemetry
-                    // format) Time unit conversion will be handled by display
-                    // functions
-                    span.start_time = span_data["startTime"].get<double>();
-                    span.duration = span_data["duration"].get<double>();
-                    if (span_data.contains("depth"))
-                    {
-                        span.depth = span_data["depth"];
-                    }
-                    else
-                    {
-                        span.depth = 0;
-                    }
+                    span.tags.emplace_back(key,
+                                           value.get<std::string>());
+                }
+            }
 
-                    // Tags (test.json format)
-                    if (span_data.contains("tags"))
+            // Events (nested-traces.json format)
+            if (span_data.contains("events"))
+            {
+                for (const auto& event : span_data["events"])
+                {
+                    std::string event_info =
+                        "Event: " + event["name"].get<std::string>();
+                    if (event.contains("timestamp"))
                     {
-                        for (const auto& tag : span_data["tags"])
-                        {
-                            span.tags.emplace_back(tag["key"], tag["value"]);
-                        }
+                        event_info +=
+                            " (timestamp: " +
+                            std::to_string(
+                                event["timestamp"].get<long>()) +
+                            ")";
                     }
+                    span.logs.push_back(event_info);
+                }
+            }
 
-                    // Attributes (nested-traces.json format)
-                    if (span_data.contains("attributes"))
-                    {
-                        for (const auto& [key, value] :
-                             span_data["attributes"].items())
-                        {
-                            span.tags.emplace_back(key,
-                                                   value.get<std::string>());
-                        }
-                    }
+            // Calculate trace time bounds
+            min_time = std::min(min_time, span.start_time);
+            max_time =
+                std::max(max_time, span.start_time + span.duration);
+
+            // Cache min/max values for optimization
+            trace.min_duration =
+                std::min(trace.min_duration, span.duration);
+            trace.max_duration =
+                std::max(trace.max_duration, span.duration);
+            trace.min_start_time =
+                std::min(trace.min_start_time, span.start_time);
+            trace.max_start_time =
+                std::max(trace.max_start_time, span.start_time);
+
+            trace.spans.push_back(span);
+        }
+    } // Close the spans existence check
 
-                    // Events (nested-traces.json format)
-                    if (span_data.contains("events"))
-                    {
-                        for (const auto& event : span_data["events"])
-                        {
-                            std::string event_info =
-                                "Event: " + event["name"].get<std::string>();
-                            if (event.contains("timestamp"))
-                            {
-                                event_info +=
-                                    " (timestamp: " +
-                                    std::to_string(
-                                        event["timestamp"].get<long>()) +
-                                    ")";
-                            }
-                            span.logs.push_back(event_info);
-                        }
-                    }
+    // Child spans refer to their parent span (listed before them): derive
+    // their depth from it, the depth field only telling root from child.
+    std::map<std::string, int> span_depths;
+    for (auto& span : trace.spans)
+    {
+        auto parent = span_depths.find(span.parent_span_id);
+        if (!span.parent_span_id.empty() && (parent != span_depths.end()))
+        {
+            span.depth = parent->second + 1;
+        }
+        span_depths[span.span_id] = span.depth;
+    }
 
-                    // Calculate trace time bounds
-                    min_time = std::min(min_time, span.start_time);
-                    max_time =
-                        std::max(max_time, span.start_time + span.duration);
-
-                    // Cache min/max values for optimization
-                    trace.min_duration =
-                        std::min(trace.min_duration, span.duration);
-                    trace.max_duration =
-                        std::max(trace.max_duration, span.duration);
-                    trace.min_start_time =
-                        std::min(trace.min_start_time, span.start_time);
-                    trace.max_start_time =
-                        std::max(trace.max_start_time, span.start_time);
-
-                    trace.spans.push_back(span);
-                }
-            } // Close the spans existence check
+    trace.start_time = min_time;
+    trace.total_duration = max_time - min_time;
+
+    // Normalize timestamps: subtract min_time from all span start_times
+    // to make them relative to the trace start
+    for (auto& span : trace.spans)
+    {
+        span.start_time -= min_time;
+    }
+
+    // Update cached min/max values after normalization
+    if (!trace.spans.empty())
+    {
+        trace.min_start_time =
+            0.0; // After normalization, minimum is always 0
+        trace.max_start_time =
+            trace.total_duration - trace.spans.back().duration;
+
+        // Recalculate these with normalized values
+        for (const auto& span : trace.spans)
+        {
+            trace.min_start_time =
+                std::min(trace.min_start_time, span.start_time);
+            trace.max_start_time =
+                std::max(trace.max_start_time, span.start_time);
+        }
+    }
+
+    // Handle empty traces
+    if (trace.spans.empty())
+    {
+        trace.min_duration = 0.0;
+        trace.max_duration = 0.0;
+        trace.min_start_time = 0.0;
+        trace.max_start_time = 0.0;
+    }
 
-            trace.start_time = min_time;
-            trace.total_duration = max_time - min_time;
+    // Sort by start time (ascending)
+    std::sort(trace.spans.begin(),
+              trace.spans.end(),
+              [](const Span& a, const Span& b)
+              { return a.start_time < b.start_time; });
 
-            // Normalize timestamps: subtract min_time from all span start_times
-            // to make them relative to the trace start
-            for (auto& span : trace.spans)
+    return trace;
+}
+
+// --------------------------------------------------------------------------
+std::string TimelineViewer::loadFromJSON(const std::string& p_json_data)
+{
+    try
+    {
+        m_traces.clear();
+
+        // Document layout: { "traces": [ ... ] }
+        nlohmann::json root =
+            nlohmann::json::parse(p_json_data, nullptr, false);
+        if (root.is_object() && root.contains("traces"))
+        {
+            for (const auto& trace_data : root["traces"])
             {
-                span.start_time -= min_time;
+                m_traces.push_back(parseTrace(trace_data));
             }
+            return {};
+        }
 
-            // Update cached min/max values after normalization
-            if (!trace.spans.empty())
+        // Newline-delimited layout: one trace object per line. The last line
+        // may have been cut by a crash of the logged process: skip it.
+        std::istringstream lines(p_json_data);
+        std::string line;
+        size_t line_number = 0u;
+        while (std::getline(lines, line))
+        {
+            ++line_number;
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
             {
-                trace.min_start_time =
-                    0.0; // After normalization, minimum is always 0
-                trace.max_start_time =
-                    trace.total_duration - trace.spans.back().duration;
-
-                // Recalculate these with normalized values
-                for (const auto& span : trace.spans)
-                {
-                    trace.min_start_time =
-                        std::min(trace.min_start_time, span.start_time);
-                    trace.max_start_time =
-                        std::max(trace.max_start_time, span.start_time);
-                }
+                continue;
             }
 
-            // Handle empty traces
-            if (trace.spans.empty())
+            nlohmann::json trace_data =
+                nlohmann::json::parse(line, nullptr, false);
+            if (trace_data.is_discarded())
             {
-                trace.min_duration = 0.0;
-                trace.max_duration = 0.0;
-                trace.min_start_time = 0.0;
-                trace.max_start_time = 0.0;
+                if (lines.peek() == std::char_traits<char>::eof())
+                {
+                    break;
+                }
+                if (m_traces.empty())
+                {
+                    // Neither layout: report the error of the document.
+                    root = nlohmann::json::parse(p_json_data);
+                }
+                return "Error: invalid JSON at line " +
+                       std::to_string(line_number);
             }
-
-            // Sort by start time (ascending)
-            std::sort(trace.spans.begin(),
-                      trace.spans.end(),
-                      [](const Span& a, const Span& b)
-                      { return a.start_time < b.start_time; });
-
-            m_traces.push_back(trace);
+            m_traces.push_back(parseTrace(trace_data));
         }
     }
-    catch (const nlohmann::json::parse_error& e)
-    {
-        std::ostringstream error_msg;
-        error_msg << "Error: " << e.what();
-        return error_msg.str();
-    }
     catch (const std::exception& e)
     {
         std::ostringstream error_msg;
@@ -615,18 +671,14 @@ void TimelineViewer::cacheTraceInformation()
 // --------------------------------------------------------------------------
 std::string TimelineViewer::loadFromFile(const std::string& p_file_path)
 {
-    std::ifstream file(p_file_path);
+    std::ifstream file(p_file_path, std::ios::binary);
     if (!file.is_open())
     {
         return "Error: Cannot open file " + p_file_path;
     }
 
-    std::string json_content;
-    std::string line;
-    while (std::getline(file, line))
-    {
-        json_content += line + "\n";
-    }
+    std::string json_content((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
     file.close();
 
     if (json_content.empty())
@@ -634,6 +686,20 @@ std::string TimelineViewer::loadFromFile(const std::string& p_file_path)
         return "Error: File " + p_file_path + " is empty";
     }
 
+    // Binary logs are converted to the JSON layout of the OpenTelemetry
+    // formatter.
+    if (BinaryLogConverter::isBinaryLog(json_content.data(),
+                                        json_content.size()))
+    {
+        std::string binary_content = std::move(json_content);
+        std::string error_message = BinaryLogConverter::toJson(
+            binary_content.data(), binary_content.size(), json_content);
+        if (!error_message.empty())
+        {
+            return error_message;
+        }
+    }
+
     std::string error_message = loadFromJSON(json_content);
     if (!error_message.empty())
     {
@@ -842,7 +908,10 @@ void TimelineViewer::showFileLoader()
                     {
                         std::string filename = entry.path().filename().string();
                         if (filename.ends_with(".json") ||
-                            filename.ends_with(".JSON"))
+                            filename.ends_with(".JSON") ||
+                            filename.ends_with(".ndjson") ||
+                            filename.ends_with(".jsonl") ||
+                            filename.ends_with(".mlb"))
                         {
                             directory_files.push_back(filename);
                         }
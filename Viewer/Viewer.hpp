@@ -53,6 +53,7 @@ struct Span
     friend std::ostream& operator<<(std::ostream& os, const Span& span);
 
     std::string span_id;
+    std::string parent_span_id;
     std::string operation_name;
     std::string service_name;
     double start_time;
@@ -267,7 +268,8 @@ class TimelineViewer
 public:
 
     // --------------------------------------------------------------------------
-    //! \brief Load the traces from a JSON file
+    //! \brief Load the traces from JSON: either a { "traces": [...] }
+    //! document or newline-delimited trace objects (NDJSON)
     //! \param p_json_data The JSON data
     //! \return The error message if the file was not loaded successfully,
     //! empty string otherwise
@@ -320,6 +322,13 @@ public:
 
 private:
 
+    // --------------------------------------------------------------------------
+    //! \brief Parse a trace object
+    //! \param p_trace_data The JSON trace object
+    //! \return The trace with its spans sorted by start time
+    // --------------------------------------------------------------------------
+    Trace parseTrace(const nlohmann::json& p_trace_data);
+
     // --------------------------------------------------------------------------
     //! \brief Clear all loaded traces
     // --------------------------------------------------------------------------
@@ -0,0 +1,607 @@
+// This translation unit replaces operator new when the allocations are
+// tracked (make benchmarks TRACK_ALLOCATIONS=1).
+#define MYLOGGER_ALLOCATION_HOOKS
+#include "MyLogger/Strategies/AllocationTracker.hpp"
+
+#include "MyLogger/MyLogger.hpp"
+#include "MyLogger/Strategies/Formatters/Binary/BinaryLineFormatter.hpp"
+#include "MyLogger/Strategies/Formatters/MsgPack/MsgPackLineFormatter.hpp"
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryFileFormatter.hpp"
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLineFormatter.hpp"
+#include "MyLogger/Strategies/Formatters/Otlp/OtlpLineFormatter.hpp"
+#include "MyLogger/Strategies/ScopedSpan.hpp"
+#include "MyLogger/Strategies/Writers/BufferedConsoleLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/ConsoleLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/FileLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/GzipFileLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/MultiSinkLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/SocketLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/UdpLogWriter.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// *****************************************************************************
+//! \brief Micro-benchmarks of the logging pipeline: trace building, line
+//! formatting and Logger::log() through each writer.
+//!
+//! Usage: mylogger-benchmarks [--benchmark_filter=<regex>]
+//!   `make run-benchmarks` from the project root also saves the results as
+//!   JSON (--benchmark_out_format=json) for tracking over time.
+//!
+//! Built with MYLOGGER_TRACK_ALLOCATIONS, each benchmark also reports the
+//! heap allocations per iteration made by Trace, the line formatter and the
+//! writer, and fails (exit code 1) when MyLogger allocates more than the
+//! budget of the benchmark: update the budget along with any change that
+//! lowers the number of allocations.
+// *****************************************************************************
+
+using LineFormatter = OpenTelemetryLineFormatter;
+using FileFormatter = OpenTelemetryFileFormatter;
+
+//! \brief File written by the file writers, removed after each benchmark.
+static const char* BENCHMARK_FILE = "mylogger-benchmark.log";
+
+//! \brief Allocations per iteration allowed to MyLogger (checked when built
+//! with MYLOGGER_TRACK_ALLOCATIONS). Fractions leave room for the amortized
+//! growth of containers.
+static constexpr double BUDGET_TRACE = 3.0;
+static constexpr double BUDGET_CHILD = 4.0;
+static constexpr double BUDGET_SCOPED_SPAN = 4.0;
+static constexpr double BUDGET_SCOPED_SPAN_NOT_SAMPLED = 0.0;
+static constexpr double BUDGET_ATTRIBUTE = 0.5;
+static constexpr double BUDGET_LOG = 36.5;
+static constexpr double BUDGET_LOG_MULTISINK = 37.5;
+template <typename LineFormatterType>
+static constexpr double BUDGET_FORMAT = 0.0;
+template <>
+constexpr double BUDGET_FORMAT<OpenTelemetryLineFormatter> = 36.0;
+template <>
+constexpr double BUDGET_FORMAT<MsgPackLineFormatter> = 2.0;
+template <>
+constexpr double BUDGET_FORMAT<OtlpLineFormatter> = 1.0;
+template <>
+constexpr double BUDGET_FORMAT<BinaryLineFormatter> = 5.5;
+
+// *****************************************************************************
+//! \brief Helpers shared by the benchmarks.
+// *****************************************************************************
+class Fixtures
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Build a trace shaped like the payment trace of doc/demo: a root
+    //! span with attributes and two child spans with attributes and events.
+    //-------------------------------------------------------------------------
+    static Trace makeRequestTrace()
+    {
+        Trace trace("payment_processing",
+                    { { "amount", "99.99" },
+                      { "currency", "EUR" },
+                      { "transaction_id", "tx_123456" } });
+
+        auto validation = trace.createChildSpan(
+            "payment_validation",
+            { { "card_type", "visa" }, { "validation_method", "3ds" } });
+        validation->addAttribute("card_last_four", "1234");
+        validation->addEvent("card_validated");
+        validation->end();
+
+        auto processing = trace.createChildSpan(
+            "payment_processing",
+            { { "gateway", "stripe" }, { "processor_id", "proc_789" } });
+        processing->addAttribute("gateway_response_time", "120ms");
+        processing->addEvent("payment_sent_to_gateway");
+        processing->addEvent("payment_confirmed");
+        processing->end();
+
+        trace.end();
+        return trace;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Start counting the allocations of a benchmark run.
+    //-------------------------------------------------------------------------
+    static void startAllocations()
+    {
+        AllocationTracker::reset();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Report the allocations per iteration of a benchmark run as
+    //! counters, and fail the benchmark when MyLogger (Trace, formatter and
+    //! writer) allocated more than p_budget times per iteration. Does nothing
+    //! unless the allocations are tracked.
+    //-------------------------------------------------------------------------
+    static void reportAllocations(benchmark::State& p_state, double p_budget)
+    {
+        using Component = AllocationTracker::Component;
+        static const Component components[] = { Component::Trace,
+                                                Component::LineFormatter,
+                                                Component::Writer };
+
+        if (!AllocationTracker::isEnabled() || (p_state.iterations() == 0))
+        {
+            return;
+        }
+
+        const auto iterations = static_cast<double>(p_state.iterations());
+        double allocations = 0.0;
+        for (Component component : components)
+        {
+            const auto counts = AllocationTracker::getCounts(component);
+            const std::string name = AllocationTracker::name(component);
+            p_state.counters["allocs." + name] =
+                static_cast<double>(counts.allocations) / iterations;
+            p_state.counters["alloc_bytes." + name] =
+                static_cast<double>(counts.bytes) / iterations;
+            allocations += static_cast<double>(counts.allocations);
+        }
+        allocations /= iterations;
+
+        // Short runs (i.e. the first run of each benchmark) are dominated by
+        // one-off allocations: key tables, container growth.
+        if ((p_state.iterations() >= MIN_BUDGET_ITERATIONS) &&
+            (allocations > p_budget))
+        {
+            s_over_budget = true;
+            const std::string error =
+                "allocation budget exceeded: " + std::to_string(allocations) +
+                " > " + std::to_string(p_budget) + " per iteration";
+            p_state.SkipWithError(error.c_str());
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if a benchmark exceeded its allocation budget.
+    //-------------------------------------------------------------------------
+    static bool isOverBudget()
+    {
+        return s_over_budget;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Size of the record of a trace formatted by a line formatter.
+    //-------------------------------------------------------------------------
+    template <typename LineFormatterType>
+    static size_t recordSize(const LineFormatterType& p_formatter,
+                             const Trace& p_trace)
+    {
+        return p_formatter.formatBegin(LogLevel::INFO, false).size() +
+               p_formatter.formatMiddle(p_trace).size() +
+               p_formatter.formatEnd().size();
+    }
+
+private:
+
+    //! \brief Runs shorter than this are not checked against the budgets.
+    static constexpr benchmark::IterationCount MIN_BUDGET_ITERATIONS = 100;
+    //! \brief A benchmark exceeded its allocation budget
+    static inline bool s_over_budget = false;
+};
+
+// *****************************************************************************
+//! \brief Redirect stdout to /dev/null while benchmarking console writers.
+// *****************************************************************************
+class SilencedStdout
+{
+public:
+
+    SilencedStdout()
+    {
+        std::cout.flush();
+        std::fflush(stdout);
+        m_saved = ::dup(STDOUT_FILENO);
+        int null = ::open("/dev/null", O_WRONLY);
+        ::dup2(null, STDOUT_FILENO);
+        ::close(null);
+    }
+
+    ~SilencedStdout()
+    {
+        std::cout.flush();
+        std::fflush(stdout);
+        ::dup2(m_saved, STDOUT_FILENO);
+        ::close(m_saved);
+    }
+
+private:
+
+    //! \brief Duplicate of the original stdout
+    int m_saved;
+};
+
+// *****************************************************************************
+//! \brief Local TCP server discarding what SocketLogWriter sends.
+// *****************************************************************************
+class DrainServer
+{
+public:
+
+    DrainServer()
+    {
+        m_listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        ::bind(m_listener, reinterpret_cast<sockaddr*>(&address), length);
+        ::listen(m_listener, 1);
+        ::getsockname(
+            m_listener, reinterpret_cast<sockaddr*>(&address), &length);
+        m_port = ntohs(address.sin_port);
+
+        m_thread = std::thread(
+            [this]()
+            {
+                int client = ::accept(m_listener, nullptr, nullptr);
+                if (client < 0)
+                {
+                    return;
+                }
+                char buffer[64 * 1024];
+                while (::read(client, buffer, sizeof(buffer)) > 0)
+                {
+                }
+                ::close(client);
+            });
+    }
+
+    ~DrainServer()
+    {
+        ::shutdown(m_listener, SHUT_RDWR);
+        m_thread.join();
+        ::close(m_listener);
+    }
+
+    unsigned short port() const
+    {
+        return m_port;
+    }
+
+private:
+
+    //! \brief Listening socket
+    int m_listener;
+    //! \brief Port bound on the loopback
+    unsigned short m_port;
+    //! \brief Thread accepting one client and draining it
+    std::thread m_thread;
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Log the request trace through a writer.
+//! \param p_budget Allocations per record allowed to MyLogger.
+//! \param p_make_writer Callable building the writer from the formatters.
+//! \param p_report Callable adding counters once the records are logged,
+//! given the state and the logger (still alive).
+//-----------------------------------------------------------------------------
+template <typename WriterType, typename Factory, typename Report>
+static void logThrough(benchmark::State& p_state,
+                       double p_budget,
+                       Factory p_make_writer,
+                       Report p_report)
+{
+    auto line_formatter = std::make_unique<LineFormatter>("benchmark", "1.0");
+    auto file_formatter = std::make_unique<FileFormatter>(
+        *line_formatter, BENCHMARK_FILE, FileMode::Create);
+    std::unique_ptr<WriterType> writer =
+        p_make_writer(*line_formatter, *file_formatter);
+    const Trace trace = Fixtures::makeRequestTrace();
+    const size_t record_size = Fixtures::recordSize(*line_formatter, trace);
+
+    {
+        Logger<WriterType, FileFormatter, LineFormatter> logger(
+            std::move(writer),
+            std::move(line_formatter),
+            std::move(file_formatter));
+
+        Fixtures::startAllocations();
+        for (auto _ : p_state)
+        {
+            logger.log(LogLevel::INFO, trace);
+        }
+        Fixtures::reportAllocations(p_state, p_budget);
+        p_report(p_state, logger);
+    }
+
+    p_state.SetItemsProcessed(p_state.iterations());
+    p_state.SetBytesProcessed(
+        static_cast<int64_t>(p_state.iterations() * record_size));
+    std::remove(BENCHMARK_FILE);
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Log the request trace through a writer, without extra counters.
+//-----------------------------------------------------------------------------
+template <typename WriterType, typename Factory>
+static void logThrough(benchmark::State& p_state,
+                       double p_budget,
+                       Factory p_make_writer)
+{
+    logThrough<WriterType>(p_state,
+                           p_budget,
+                           p_make_writer,
+                           [](benchmark::State&, auto&)
+                           {
+                           });
+}
+
+//-----------------------------------------------------------------------------
+static void BM_TraceConstruction(benchmark::State& p_state)
+{
+    Fixtures::startAllocations();
+    for (auto _ : p_state)
+    {
+        Trace trace("request", { { "component", "main" } });
+        benchmark::DoNotOptimize(trace);
+    }
+    Fixtures::reportAllocations(p_state, BUDGET_TRACE);
+}
+BENCHMARK(BM_TraceConstruction);
+
+//-----------------------------------------------------------------------------
+static void BM_CreateChildSpan(benchmark::State& p_state)
+{
+    // The root is renewed so that its children do not pile up.
+    auto root = std::make_unique<Trace>("request");
+    size_t children = 0u;
+    Fixtures::startAllocations();
+    for (auto _ : p_state)
+    {
+        auto child = root->createChildSpan("child");
+        benchmark::DoNotOptimize(child);
+        if (++children == 1024u)
+        {
+            root = std::make_unique<Trace>("request");
+            children = 0u;
+        }
+    }
+    Fixtures::reportAllocations(p_state, BUDGET_CHILD);
+}
+BENCHMARK(BM_CreateChildSpan);
+
+//-----------------------------------------------------------------------------
+//! \brief Threads creating child spans of the same root. Allocations are
+//! not reported since the counters are per thread.
+//-----------------------------------------------------------------------------
+static void BM_CreateChildSpanConcurrent(benchmark::State& p_state)
+{
+    static std::unique_ptr<Trace> root;
+    if (p_state.thread_index() == 0)
+    {
+        root = std::make_unique<Trace>("request");
+    }
+    for (auto _ : p_state)
+    {
+        auto child = root->createChildSpan("child");
+        benchmark::DoNotOptimize(child);
+    }
+    if (p_state.thread_index() == 0)
+    {
+        root.reset();
+    }
+    p_state.SetItemsProcessed(p_state.iterations());
+}
+BENCHMARK(BM_CreateChildSpanConcurrent)->Iterations(20000)->ThreadRange(1, 8);
+
+//-----------------------------------------------------------------------------
+static void BM_ScopedSpan(benchmark::State& p_state)
+{
+    // The root is renewed so that its children do not pile up.
+    auto root = std::make_unique<Trace>("request");
+    size_t children = 0u;
+    Fixtures::startAllocations();
+    for (auto _ : p_state)
+    {
+        {
+            ScopedSpan span(*root, "span");
+            benchmark::DoNotOptimize(span.getSpan());
+        }
+        if (++children == 1024u)
+        {
+            root = std::make_unique<Trace>("request");
+            children = 0u;
+        }
+    }
+    Fixtures::reportAllocations(p_state, BUDGET_SCOPED_SPAN);
+}
+BENCHMARK(BM_ScopedSpan);
+
+//-----------------------------------------------------------------------------
+static void BM_ScopedSpanNotSampled(benchmark::State& p_state)
+{
+    Trace root("request");
+    root.setSampled(false);
+    Fixtures::startAllocations();
+    for (auto _ : p_state)
+    {
+        ScopedSpan outer(root, "outer");
+        ScopedSpan inner("inner");
+        benchmark::DoNotOptimize(inner.getSpan());
+    }
+    Fixtures::reportAllocations(p_state, BUDGET_SCOPED_SPAN_NOT_SAMPLED);
+}
+BENCHMARK(BM_ScopedSpanNotSampled);
+
+//-----------------------------------------------------------------------------
+static void BM_AddAttribute(benchmark::State& p_state)
+{
+    static const std::string keys[] = { "http.method", "http.url",
+                                        "http.status", "user.id",
+                                        "db.system",   "db.statement",
+                                        "peer.host",   "peer.port" };
+    Trace trace("request");
+    size_t i = 0u;
+    Fixtures::startAllocations();
+    for (auto _ : p_state)
+    {
+        trace.addAttribute(keys[i++ & 7u], "value");
+    }
+    Fixtures::reportAllocations(p_state, BUDGET_ATTRIBUTE);
+}
+BENCHMARK(BM_AddAttribute);
+
+//-----------------------------------------------------------------------------
+//! \brief Format a whole record (begin, middle, end) of the request trace.
+//-----------------------------------------------------------------------------
+template <typename LineFormatterType>
+static void BM_FormatLine(benchmark::State& p_state)
+{
+    LineFormatterType formatter("benchmark", "1.0");
+    const Trace trace = Fixtures::makeRequestTrace();
+    Fixtures::startAllocations();
+    for (auto _ : p_state)
+    {
+        std::string begin = formatter.formatBegin(LogLevel::INFO, false);
+        std::string middle = formatter.formatMiddle(trace);
+        std::string end = formatter.formatEnd();
+        benchmark::DoNotOptimize(begin);
+        benchmark::DoNotOptimize(middle);
+        benchmark::DoNotOptimize(end);
+    }
+    Fixtures::reportAllocations(p_state, BUDGET_FORMAT<LineFormatterType>);
+    p_state.SetBytesProcessed(static_cast<int64_t>(
+        p_state.iterations() * Fixtures::recordSize(formatter, trace)));
+}
+BENCHMARK_TEMPLATE(BM_FormatLine, OpenTelemetryLineFormatter);
+BENCHMARK_TEMPLATE(BM_FormatLine, MsgPackLineFormatter);
+BENCHMARK_TEMPLATE(BM_FormatLine, OtlpLineFormatter);
+BENCHMARK_TEMPLATE(BM_FormatLine, BinaryLineFormatter);
+
+//-----------------------------------------------------------------------------
+static void BM_LogConsole(benchmark::State& p_state)
+{
+    SilencedStdout silenced;
+    logThrough<ConsoleLogWriter<LineFormatter>>(
+        p_state,
+        BUDGET_LOG,
+        [](LineFormatter& p_line, FileFormatter&)
+        { return std::make_unique<ConsoleLogWriter<LineFormatter>>(p_line); });
+}
+BENCHMARK(BM_LogConsole);
+
+//-----------------------------------------------------------------------------
+static void BM_LogBufferedConsole(benchmark::State& p_state)
+{
+    SilencedStdout silenced;
+    logThrough<BufferedConsoleLogWriter<LineFormatter>>(
+        p_state,
+        BUDGET_LOG,
+        [](LineFormatter& p_line, FileFormatter&)
+        {
+            return std::make_unique<BufferedConsoleLogWriter<LineFormatter>>(
+                p_line);
+        });
+}
+BENCHMARK(BM_LogBufferedConsole);
+
+//-----------------------------------------------------------------------------
+static void BM_LogFile(benchmark::State& p_state)
+{
+    logThrough<FileLogWriter<LineFormatter>>(
+        p_state,
+        BUDGET_LOG,
+        [](LineFormatter&, FileFormatter& p_file)
+        { return std::make_unique<FileLogWriter<LineFormatter>>(p_file); });
+}
+BENCHMARK(BM_LogFile);
+
+//-----------------------------------------------------------------------------
+static void BM_LogGzipFile(benchmark::State& p_state)
+{
+    logThrough<GzipFileLogWriter<LineFormatter>>(
+        p_state,
+        BUDGET_LOG,
+        [](LineFormatter&, FileFormatter& p_file)
+        { return std::make_unique<GzipFileLogWriter<LineFormatter>>(p_file); },
+        [](benchmark::State& p_bench, auto& p_logger)
+        {
+            // Compress the pending frame so that every record is counted.
+            p_logger.flush();
+            const auto& writer = p_logger.getWriter();
+            const double compressed =
+                static_cast<double>(writer.getCompressedBytes());
+            p_bench.counters["ratio"] =
+                (compressed > 0.0)
+                    ? static_cast<double>(writer.getUncompressedBytes()) /
+                          compressed
+                    : 0.0;
+            p_bench.counters["compressed_bytes_per_second"] =
+                benchmark::Counter(compressed, benchmark::Counter::kIsRate);
+        });
+}
+BENCHMARK(BM_LogGzipFile);
+
+//-----------------------------------------------------------------------------
+static void BM_LogMultiSink(benchmark::State& p_state)
+{
+    logThrough<MultiSinkLogWriter<LineFormatter>>(
+        p_state,
+        BUDGET_LOG_MULTISINK,
+        [](LineFormatter& p_line, FileFormatter& p_file)
+        {
+            auto writer =
+                std::make_unique<MultiSinkLogWriter<LineFormatter>>(p_line);
+            writer->addSink(
+                std::make_unique<FileLogWriter<LineFormatter>>(p_file));
+            return writer;
+        });
+}
+BENCHMARK(BM_LogMultiSink);
+
+//-----------------------------------------------------------------------------
+static void BM_LogUdp(benchmark::State& p_state)
+{
+    // Fire-and-forget: nobody needs to listen.
+    logThrough<UdpLogWriter<LineFormatter>>(
+        p_state,
+        BUDGET_LOG,
+        [](LineFormatter& p_line, FileFormatter&)
+        {
+            return std::make_unique<UdpLogWriter<LineFormatter>>(
+                "127.0.0.1", 9, p_line);
+        });
+}
+BENCHMARK(BM_LogUdp);
+
+//-----------------------------------------------------------------------------
+static void BM_LogSocket(benchmark::State& p_state)
+{
+    DrainServer server;
+    logThrough<SocketLogWriter<LineFormatter>>(
+        p_state,
+        BUDGET_LOG,
+        [&server](LineFormatter& p_line, FileFormatter&)
+        {
+            return std::make_unique<SocketLogWriter<LineFormatter>>(
+                "127.0.0.1", server.port(), p_line);
+        });
+}
+BENCHMARK(BM_LogSocket);
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return Fixtures::isOverBudget() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
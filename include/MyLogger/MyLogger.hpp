@@ -2,7 +2,12 @@
 
 #include "MyLogger/Strategies/LogLineFormatter.hpp"
 #include "MyLogger/Strategies/LogWriter.hpp"
+#include "MyLogger/Strategies/LoggerMetrics.hpp"
+#include "MyLogger/Strategies/RateLimiter.hpp"
+#include "MyLogger/Strategies/TraceSampler.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
 
@@ -36,9 +41,9 @@ public:
     explicit Logger(std::unique_ptr<WriterType> p_writer,
                     std::unique_ptr<LineFormatterType> p_line_formatter,
                     std::unique_ptr<FileFormatterType> p_file_formatter)
-        : m_writer(std::move(p_writer)),
-          m_line_formatter(std::move(p_line_formatter)),
-          m_file_formatter(std::move(p_file_formatter))
+        : m_line_formatter(std::move(p_line_formatter)),
+          m_file_formatter(std::move(p_file_formatter)),
+          m_writer(std::move(p_writer))
     {
         std::lock_guard<std::mutex> lock(m_log_mutex);
         m_writer->writeHeader(*m_file_formatter);
@@ -50,6 +55,11 @@ public:
     ~Logger()
     {
         std::lock_guard<std::mutex> lock(m_log_mutex);
+        writeRateLimiterSummary(RateLimiter::Clock::now());
+        if (m_self_report_period.count() > 0)
+        {
+            writeSelfReport(LoggerMetrics::Clock::now());
+        }
         m_writer->writeFooter(*m_file_formatter);
     }
 
@@ -60,8 +70,62 @@ public:
     //-------------------------------------------------------------------------
     void log(LogLevel p_level, const Trace& p_trace)
     {
+        // Streamed traces are logged span by span by their exporter.
+        if (p_trace.isStreaming())
+        {
+            return;
+        }
+
+        // Head decision stored on the trace, or taken now if the root was
+        // not sampled at creation: no lock needed to drop the trace.
+        if (!m_head_sampler.isSampled(p_trace))
+        {
+            ++m_sampled_out_traces;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_log_mutex);
+        checkSelfReport();
+        if (isAdmitted(p_level, p_trace))
+        {
+            m_writer->writeLine(p_level, p_trace);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Log a single ended span (streaming mode). Usually called by
+    //! the exporter returned by spanExporter(). As for log(), the span goes
+    //! through the tail sampler and the rate limiter: since the trace is not
+    //! complete yet, they decide from the level, duration and operation name
+    //! of the span alone.
+    //! \param p_level The log level.
+    //! \param p_span The span, logged without its child spans.
+    //-------------------------------------------------------------------------
+    void logSpan(LogLevel p_level, const Trace& p_span)
+    {
+        if (!m_head_sampler.isSampled(p_span))
+        {
+            return;
+        }
+
         std::lock_guard<std::mutex> lock(m_log_mutex);
-        m_writer->writeLine(p_level, p_trace);
+        checkSelfReport();
+        if (isAdmitted(p_level, p_span))
+        {
+            m_writer->writeSpan(p_level, p_span);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get an exporter logging the spans of a streamed trace as they
+    //! end (see Trace::setSpanExporter()). The logger shall outlive the
+    //! spans. log() ignores streamed traces.
+    //! \param p_level The level of the span records.
+    //-------------------------------------------------------------------------
+    Trace::SpanExporter spanExporter(LogLevel p_level = LogLevel::INFO)
+    {
+        return [this, p_level](const Trace& p_span)
+        { logSpan(p_level, p_span); };
     }
 
     //-------------------------------------------------------------------------
@@ -72,6 +136,7 @@ public:
     void log(LogLevel p_level, const std::string& p_message)
     {
         std::lock_guard<std::mutex> lock(m_log_mutex);
+        checkSelfReport();
         m_writer->writeLine(p_level, p_message);
     }
 
@@ -84,6 +149,109 @@ public:
         m_writer->flush();
     }
 
+    //-------------------------------------------------------------------------
+    //! \brief Take the head sampling decision of a newly created root trace
+    //! and store it on the trace. Call it before creating child spans so that
+    //! they inherit the decision: a sampled-out trace then records nothing.
+    //! Without this call, the trace is recorded and log() takes the decision.
+    //! Lock-free: it does not wait for the writer.
+    //! \param p_trace The root trace.
+    //! \return true if the trace is sampled.
+    //-------------------------------------------------------------------------
+    bool sample(Trace& p_trace)
+    {
+        return m_head_sampler.sample(p_trace);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Set the head sampler used by sample(). Lock-free.
+    //-------------------------------------------------------------------------
+    void setHeadSampler(const HeadSampler& p_sampler)
+    {
+        m_head_sampler = p_sampler;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Set the tail sampler filtering the logged traces.
+    //-------------------------------------------------------------------------
+    void setTailSampler(const TailSampler& p_sampler)
+    {
+        std::lock_guard<std::mutex> lock(m_log_mutex);
+        m_tail_sampler = p_sampler;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Set the rate limiter of the traces, keyed by operation name.
+    //! \param p_config Rates and summary period (rate 0 disables it).
+    //-------------------------------------------------------------------------
+    void setRateLimiter(const RateLimiterConfig& p_config)
+    {
+        std::lock_guard<std::mutex> lock(m_log_mutex);
+        writeRateLimiterSummary(RateLimiter::Clock::now());
+        m_rate_limiter = RateLimiter(p_config);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of traces suppressed by the current rate limiter.
+    //-------------------------------------------------------------------------
+    uint64_t getRateLimitedTraces()
+    {
+        std::lock_guard<std::mutex> lock(m_log_mutex);
+        return m_rate_limiter.getSuppressedTraces();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of traces not logged because of sampling.
+    //-------------------------------------------------------------------------
+    uint64_t getSampledOutTraces() const
+    {
+        return m_sampled_out_traces;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Enable or disable the self-instrumentation of the logger (see
+    //! LoggerMetrics). Disabled by default. The counters are kept while
+    //! disabled.
+    //-------------------------------------------------------------------------
+    void enableMetrics(bool p_enable = true)
+    {
+        std::lock_guard<std::mutex> lock(m_log_mutex);
+        m_writer->setMetrics(p_enable ? &m_metrics : nullptr);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get a snapshot of the self-instrumentation counters. Records
+    //! are only counted while metrics are enabled.
+    //-------------------------------------------------------------------------
+    LoggerMetricsSnapshot getMetrics()
+    {
+        LoggerMetricsSnapshot snapshot = m_metrics.snapshot();
+        snapshot.sampled_out = m_sampled_out_traces;
+        snapshot.rate_limited = getRateLimitedTraces();
+        return snapshot;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Periodically log the metrics through the writer, as a
+    //! LoggerMetrics::REPORT_NAME trace with one attribute per counter. The
+    //! report is written by the first log call after each period, and when
+    //! the logger is destroyed. Enables the metrics.
+    //! \param p_period Period of the reports (0 stops the reports).
+    //! \param p_level Level of the report records.
+    //-------------------------------------------------------------------------
+    void setSelfReport(std::chrono::milliseconds p_period,
+                       LogLevel p_level = LogLevel::INFO)
+    {
+        std::lock_guard<std::mutex> lock(m_log_mutex);
+        m_self_report_period = p_period;
+        m_self_report_level = p_level;
+        m_next_self_report = LoggerMetrics::Clock::now() + p_period;
+        if (p_period.count() > 0)
+        {
+            m_writer->setMetrics(&m_metrics);
+        }
+    }
+
     //-------------------------------------------------------------------------
     //! \brief Get a reference to the writer.
     //-------------------------------------------------------------------------
@@ -98,12 +266,132 @@ public:
 
 private:
 
-    //! \brief The writer.
-    std::unique_ptr<WriterType> m_writer;
+    //-------------------------------------------------------------------------
+    //! \brief Apply the tail sampler and the rate limiter to a sampled trace
+    //! or span. Called under lock.
+    //! \return true if the trace shall be written.
+    //-------------------------------------------------------------------------
+    bool isAdmitted(LogLevel p_level, const Trace& p_trace)
+    {
+        if (!m_tail_sampler.shouldKeep(p_level, p_trace))
+        {
+            ++m_sampled_out_traces;
+            return false;
+        }
+        if (m_rate_limiter.isEnabled())
+        {
+            const auto now = RateLimiter::Clock::now();
+            if (m_rate_limiter.isSummaryDue(now))
+            {
+                writeRateLimiterSummary(now);
+            }
+            if (!m_rate_limiter.tryAcquire(p_trace.getOperationName(), now))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Log the number of traces suppressed by the rate limiter since
+    //! the last summary, if any. Called under lock.
+    //-------------------------------------------------------------------------
+    void writeRateLimiterSummary(RateLimiter::Clock::time_point p_now)
+    {
+        Trace summary(RateLimiter::SUMMARY_NAME);
+        if (m_rate_limiter.summarize(summary, p_now))
+        {
+            summary.end();
+            m_writer->writeLine(LogLevel::WARNING, summary);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the self-report if it is due. Called under lock.
+    //-------------------------------------------------------------------------
+    void checkSelfReport()
+    {
+        if (m_self_report_period.count() > 0)
+        {
+            const auto now = LoggerMetrics::Clock::now();
+            if (now >= m_next_self_report)
+            {
+                writeSelfReport(now);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Log the metrics through the writer. Called under lock.
+    //-------------------------------------------------------------------------
+    void writeSelfReport(LoggerMetrics::Clock::time_point p_now)
+    {
+        static const LogLevel levels[LoggerMetricsSnapshot::LEVELS] = {
+            LogLevel::TRACE, LogLevel::DEBUG, LogLevel::INFO,
+            LogLevel::WARNING, LogLevel::ERROR, LogLevel::FATAL
+        };
+
+        m_next_self_report = p_now + m_self_report_period;
+        LoggerMetricsSnapshot snapshot = m_metrics.snapshot();
+        Trace report(LoggerMetrics::REPORT_NAME);
+        for (LogLevel level : levels)
+        {
+            report.addAttribute("records." + to_string(level),
+                                std::to_string(snapshot.getRecords(level)));
+        }
+        report.addAttribute("bytes", std::to_string(snapshot.bytes));
+        report.addAttribute("dropped", std::to_string(snapshot.dropped));
+        report.addAttribute("sampled_out",
+                            std::to_string(m_sampled_out_traces.load()));
+        report.addAttribute(
+            "rate_limited",
+            std::to_string(m_rate_limiter.getSuppressedTraces()));
+        report.addAttribute("queue_high_water",
+                            std::to_string(snapshot.queue_high_water));
+        report.addAttribute("flushes", std::to_string(snapshot.flushes));
+        addLatency(report, "format_ns", snapshot.format_time);
+        addLatency(report, "write_ns", snapshot.write_time);
+        report.end();
+        m_writer->writeLine(m_self_report_level, report);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Add the percentiles of a latency summary to a report.
+    //-------------------------------------------------------------------------
+    static void addLatency(Trace& p_report,
+                           const std::string& p_name,
+                           const LatencySummary& p_latency)
+    {
+        p_report.addAttribute(p_name + ".p50", std::to_string(p_latency.p50));
+        p_report.addAttribute(p_name + ".p99", std::to_string(p_latency.p99));
+        p_report.addAttribute(p_name + ".max", std::to_string(p_latency.max));
+    }
+
     //! \brief The line formatter.
     std::unique_ptr<LineFormatterType> m_line_formatter;
     //! \brief The file formatter.
     std::unique_ptr<FileFormatterType> m_file_formatter;
     //! \brief The log mutex.
     std::mutex m_log_mutex;
+    //! \brief Head sampling of the root traces.
+    HeadSampler m_head_sampler;
+    //! \brief Tail sampling of the logged traces.
+    TailSampler m_tail_sampler;
+    //! \brief Rate limiting of the traces per operation name.
+    RateLimiter m_rate_limiter;
+    //! \brief Number of traces not logged because of sampling.
+    std::atomic<uint64_t> m_sampled_out_traces{ 0u };
+    //! \brief Self-instrumentation, fed by the writer once enabled.
+    LoggerMetrics m_metrics;
+    //! \brief Period of the self-report (0 if disabled).
+    std::chrono::milliseconds m_self_report_period{ 0 };
+    //! \brief Level of the self-report records.
+    LogLevel m_self_report_level = LogLevel::INFO;
+    //! \brief Time of the next self-report.
+    LoggerMetrics::Clock::time_point m_next_self_report;
+    //! \brief The writer. Declared last so that it is destroyed first: it
+    //! may still use the formatters and feed the metrics while writing its
+    //! pending records.
+    std::unique_ptr<WriterType> m_writer;
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "MyLogger/MyLogger.hpp"
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryFileFormatter.hpp"
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLineFormatter.hpp"
+#include "MyLogger/Strategies/Writers/ConsoleLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/FileLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/SocketLogWriter.hpp"
+
+// *****************************************************************************
+//! \brief Loggers writing OpenTelemetry JSON to a file, the console or a
+//! socket: the most common combinations, compiled once in the MyLogger
+//! library (see src/OpenTelemetryLoggers.cpp).
+//!
+//! Including this header instead of the individual headers declares these
+//! instantiations extern, so that the including translation unit does not
+//! compile Logger, the writers and the formatter bases again: it shall be
+//! linked against the MyLogger library. Define MYLOGGER_HEADER_ONLY to use
+//! the aliases without the library (the templates are then instantiated by
+//! each translation unit as usual).
+// *****************************************************************************
+
+//! \brief Logger writing OpenTelemetry JSON into a file.
+using OpenTelemetryFileLogger =
+    Logger<FileLogWriter<OpenTelemetryLineFormatter>,
+           OpenTelemetryFileFormatter,
+           OpenTelemetryLineFormatter>;
+
+//! \brief Logger writing OpenTelemetry JSON on the console.
+using OpenTelemetryConsoleLogger =
+    Logger<ConsoleLogWriter<OpenTelemetryLineFormatter>,
+           OpenTelemetryFileFormatter,
+           OpenTelemetryLineFormatter>;
+
+//! \brief Logger sending OpenTelemetry JSON records to a TCP collector.
+using OpenTelemetrySocketLogger =
+    Logger<SocketLogWriter<OpenTelemetryLineFormatter>,
+           OpenTelemetryFileFormatter,
+           OpenTelemetryLineFormatter>;
+
+#if !defined(MYLOGGER_HEADER_ONLY)
+extern template class LogLineFormatter<OpenTelemetryLineFormatter>;
+extern template class LogFileFormatter<OpenTelemetryFileFormatter,
+                                       OpenTelemetryLineFormatter>;
+
+extern template class LogWriter<FileLogWriter<OpenTelemetryLineFormatter>,
+                                OpenTelemetryLineFormatter>;
+extern template class FileLogWriter<OpenTelemetryLineFormatter>;
+extern template class Logger<FileLogWriter<OpenTelemetryLineFormatter>,
+                             OpenTelemetryFileFormatter,
+                             OpenTelemetryLineFormatter>;
+
+extern template class LogWriter<ConsoleLogWriter<OpenTelemetryLineFormatter>,
+                                OpenTelemetryLineFormatter>;
+extern template class ConsoleLogWriter<OpenTelemetryLineFormatter>;
+extern template class Logger<ConsoleLogWriter<OpenTelemetryLineFormatter>,
+                             OpenTelemetryFileFormatter,
+                             OpenTelemetryLineFormatter>;
+
+extern template class LogWriter<SocketLogWriter<OpenTelemetryLineFormatter>,
+                                OpenTelemetryLineFormatter>;
+extern template class SocketLogWriter<OpenTelemetryLineFormatter>;
+extern template class Logger<SocketLogWriter<OpenTelemetryLineFormatter>,
+                             OpenTelemetryFileFormatter,
+                             OpenTelemetryLineFormatter>;
+#endif
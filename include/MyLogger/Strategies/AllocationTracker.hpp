@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// *****************************************************************************
+//! \brief Heap allocation counters of the logging hot path, for the opt-in
+//! build mode MYLOGGER_TRACK_ALLOCATIONS.
+//!
+//! When MYLOGGER_TRACK_ALLOCATIONS is defined, Trace, the line formatters
+//! and the writers open a MYLOGGER_ALLOCATION_SCOPE, and the replaced global
+//! operator new accounts each allocation to the innermost open scope of the
+//! calling thread (Component::Other outside any scope). Otherwise the scopes
+//! compile to nothing and nothing is counted.
+//!
+//! The replacement of operator new is defined by the translation unit that
+//! defines MYLOGGER_ALLOCATION_HOOKS before including this file, which shall
+//! be done by a single translation unit of the program (i.e. the benchmark
+//! suite). Counters are per thread: allocations made by writer threads are
+//! counted on these threads.
+// *****************************************************************************
+class AllocationTracker
+{
+public:
+
+    //! \brief Code to which allocations are accounted.
+    enum class Component
+    {
+        Other,         //!< Outside any scope (caller code)
+        Trace,         //!< Trace and its spans, attributes and events
+        LineFormatter, //!< Line formatters
+        Writer         //!< LogWriter and derived writers
+    };
+
+    //! \brief Number of components.
+    static constexpr size_t COMPONENTS = 4u;
+
+    //! \brief Allocations of a component. Plain data (no member initializer)
+    //! so that the thread-local counters need no dynamic initialization.
+    struct Counts
+    {
+        //! \brief Number of allocations
+        uint64_t allocations;
+        //! \brief Number of bytes allocated
+        uint64_t bytes;
+    };
+
+    // *************************************************************************
+    //! \brief Account the allocations of the calling thread to a component
+    //! until the scope is left.
+    // *************************************************************************
+    class Scope
+    {
+    public:
+
+        explicit Scope(Component p_component) : m_previous(s_current)
+        {
+            s_current = p_component;
+        }
+
+        ~Scope()
+        {
+            s_current = m_previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+
+        //! \brief Component of the enclosing scope
+        Component m_previous;
+    };
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the allocations are tracked by this build.
+    //-------------------------------------------------------------------------
+    static constexpr bool isEnabled()
+    {
+#if defined(MYLOGGER_TRACK_ALLOCATIONS)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Account an allocation to the current component. Called by the
+    //! replaced operator new.
+    //-------------------------------------------------------------------------
+    static void onAllocation(size_t p_size)
+    {
+        Counts& counts = s_counts[static_cast<size_t>(s_current)];
+        ++counts.allocations;
+        counts.bytes += p_size;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the allocations of a component made by the calling thread
+    //! since the last reset().
+    //-------------------------------------------------------------------------
+    static Counts getCounts(Component p_component)
+    {
+        return s_counts[static_cast<size_t>(p_component)];
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Reset the counters of the calling thread.
+    //-------------------------------------------------------------------------
+    static void reset()
+    {
+        for (Counts& counts : s_counts)
+        {
+            counts = Counts{ 0u, 0u };
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the name of a component.
+    //-------------------------------------------------------------------------
+    static const char* name(Component p_component)
+    {
+        switch (p_component)
+        {
+            case Component::Trace:
+                return "trace";
+            case Component::LineFormatter:
+                return "formatter";
+            case Component::Writer:
+                return "writer";
+            default:
+                return "other";
+        }
+    }
+
+private:
+
+    //! \brief Component of the innermost scope of the thread
+    static inline thread_local Component s_current = Component::Other;
+    //! \brief Allocations of the thread per component
+    static inline thread_local Counts s_counts[COMPONENTS];
+};
+
+#if defined(MYLOGGER_TRACK_ALLOCATIONS)
+#    define MYLOGGER_ALLOCATION_SCOPE(component)                               \
+        AllocationTracker::Scope mylogger_allocation_scope(                   \
+            AllocationTracker::Component::component)
+#else
+#    define MYLOGGER_ALLOCATION_SCOPE(component)
+#endif
+
+#if defined(MYLOGGER_TRACK_ALLOCATIONS) && defined(MYLOGGER_ALLOCATION_HOOKS)
+
+// Replaceable allocation functions counting into AllocationTracker. The
+// deallocation functions are replaced too since they must match malloc().
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic push
+#        pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#    endif
+
+void* operator new(std::size_t p_size)
+{
+    AllocationTracker::onAllocation(p_size);
+    if (void* memory = std::malloc(p_size == 0u ? 1u : p_size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t p_size)
+{
+    return ::operator new(p_size);
+}
+
+void* operator new(std::size_t p_size, const std::nothrow_t&) noexcept
+{
+    AllocationTracker::onAllocation(p_size);
+    return std::malloc(p_size == 0u ? 1u : p_size);
+}
+
+void* operator new[](std::size_t p_size, const std::nothrow_t&) noexcept
+{
+    return ::operator new(p_size, std::nothrow);
+}
+
+void operator delete(void* p_memory) noexcept
+{
+    std::free(p_memory);
+}
+
+void operator delete[](void* p_memory) noexcept
+{
+    std::free(p_memory);
+}
+
+void operator delete(void* p_memory, std::size_t) noexcept
+{
+    std::free(p_memory);
+}
+
+void operator delete[](void* p_memory, std::size_t) noexcept
+{
+    std::free(p_memory);
+}
+
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic pop
+#    endif
+#endif
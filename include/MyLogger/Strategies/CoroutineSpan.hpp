@@ -0,0 +1,332 @@
+#pragma once
+
+#include "MyLogger/Strategies/AllocationTracker.hpp"
+#include "MyLogger/Strategies/LogTrace.hpp"
+#include "MyLogger/Strategies/TraceContext.hpp"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#    include <coroutine>
+#    include <initializer_list>
+#    include <memory>
+#    include <utility>
+
+// *****************************************************************************
+//! \brief Span of a C++20 coroutine, keeping the span active on the thread
+//! (see TraceContext) right across co_await suspension points.
+//!
+//! A ScopedSpan shall not live across a co_await: the coroutine may resume
+//! on another thread and, while it is suspended, the thread runs other code
+//! under the span. A CoroutineSpan lives in the coroutine frame instead and
+//! the awaits are wrapped with wrap(): when the coroutine suspends, the
+//! thread gets back the span active before the coroutine ran; when it
+//! resumes, on whatever thread, the span of the coroutine is made active
+//! again. Switching is a pointer swap on a state kept in the frame, without
+//! allocation per resume.
+//! \code
+//!   Task<void> handle(Request request)
+//!   {
+//!       CoroutineSpan span("handle");          // child of the active span
+//!       auto body = co_await span.wrap(read(request));
+//!       {
+//!           CoroutineSpan parse(span, "parse"); // nested in the coroutine
+//!           co_await parse.wrap(decode(body));
+//!       }
+//!   }
+//! \endcode
+//! Code between two awaits sees the span as TraceContext::current(), so that
+//! ScopedSpan and other code not aware of coroutines parent their spans to
+//! it. Lazily started coroutines (suspended before their body) shall give
+//! their parent explicitly, captured by the caller with
+//! TraceContext::capture().
+//!
+//! As for ScopedSpan, nothing is recorded nor allocated when the parent is
+//! not sampled. Otherwise the span is created by Trace::createChildSpan()
+//! and allocates as much as a recorded ScopedSpan.
+// *****************************************************************************
+class CoroutineSpan
+{
+public:
+
+    using AttributeList =
+        std::initializer_list<std::pair<const char*, const char*>>;
+
+    // *************************************************************************
+    //! \brief Awaiter forwarding to the awaiter of an awaitable, switching
+    //! the active span of the thread when the coroutine suspends and resumes.
+    // *************************************************************************
+    template <typename Awaitable>
+    class Awaiter
+    {
+    public:
+
+        Awaiter(CoroutineSpan& p_span, Awaitable&& p_awaitable)
+            : m_span(p_span),
+              m_awaitable(std::forward<Awaitable>(p_awaitable)),
+              m_awaiter(getAwaiter(std::forward<Awaitable>(m_awaitable)))
+        {
+        }
+
+        Awaiter(const Awaiter&) = delete;
+        Awaiter& operator=(const Awaiter&) = delete;
+
+        bool await_ready()
+        {
+            return m_awaiter.await_ready();
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Give the thread back its span before suspending: once
+        //! suspended, the coroutine may be resumed and this awaiter destroyed
+        //! by another thread.
+        //---------------------------------------------------------------------
+        template <typename Promise>
+        decltype(auto) await_suspend(std::coroutine_handle<Promise> p_handle)
+        {
+            m_suspended = true;
+            m_span.suspend();
+            return m_awaiter.await_suspend(p_handle);
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Make the span active again if the coroutine went through
+        //! await_suspend(). When await_ready() is true, the coroutine never
+        //! left the span: swapping would record the span itself as the span
+        //! of the thread, left active after the coroutine ends.
+        //---------------------------------------------------------------------
+        decltype(auto) await_resume()
+        {
+            if (m_suspended)
+            {
+                m_span.resume();
+            }
+            return m_awaiter.await_resume();
+        }
+
+    private:
+
+        //---------------------------------------------------------------------
+        //! \brief Get the awaiter of an awaitable, as co_await does.
+        //---------------------------------------------------------------------
+        template <typename Type>
+        static decltype(auto) getAwaiter(Type&& p_awaitable)
+        {
+            if constexpr (requires {
+                              std::forward<Type>(p_awaitable)
+                                  .operator co_await();
+                          })
+            {
+                return std::forward<Type>(p_awaitable).operator co_await();
+            }
+            else if constexpr (requires {
+                                   operator co_await(
+                                       std::forward<Type>(p_awaitable));
+                               })
+            {
+                return operator co_await(std::forward<Type>(p_awaitable));
+            }
+            else
+            {
+                return std::forward<Type>(p_awaitable);
+            }
+        }
+
+        //! \brief The span of the awaiting coroutine
+        CoroutineSpan& m_span;
+        //! \brief The awaitable (a reference when given as lvalue)
+        Awaitable m_awaitable;
+        //! \brief Its awaiter (a reference to m_awaitable when it is one)
+        decltype(getAwaiter(std::declval<Awaitable>())) m_awaiter;
+        //! \brief await_suspend() has been called
+        bool m_suspended = false;
+    };
+
+    //-------------------------------------------------------------------------
+    //! \brief Start a span child of the span active on this thread.
+    //! \param p_operation_name The name of the operation.
+    //! \param p_attributes Key-value pairs for the span attributes.
+    //-------------------------------------------------------------------------
+    explicit CoroutineSpan(const char* p_operation_name,
+                           AttributeList p_attributes = {})
+        : CoroutineSpan(TraceContext::current(),
+                        nullptr,
+                        p_operation_name,
+                        p_attributes)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Start a span child of the given trace.
+    //! \param p_parent The parent trace. It shall outlive the span.
+    //! \param p_operation_name The name of the operation.
+    //! \param p_attributes Key-value pairs for the span attributes.
+    //-------------------------------------------------------------------------
+    CoroutineSpan(Trace& p_parent,
+                  const char* p_operation_name,
+                  AttributeList p_attributes = {})
+        : CoroutineSpan(&p_parent, nullptr, p_operation_name, p_attributes)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Start a span child of a span captured by the caller of the
+    //! coroutine (see TraceContext::capture()).
+    //! \param p_parent The captured parent span.
+    //! \param p_operation_name The name of the operation.
+    //! \param p_attributes Key-value pairs for the span attributes.
+    //-------------------------------------------------------------------------
+    CoroutineSpan(const TraceContext::Snapshot& p_parent,
+                  const char* p_operation_name,
+                  AttributeList p_attributes = {})
+        : CoroutineSpan(p_parent.getSpan(),
+                        nullptr,
+                        p_operation_name,
+                        p_attributes)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Start a span child of an enclosing span of the same coroutine.
+    //! \param p_parent The enclosing span. It shall outlive this one.
+    //! \param p_operation_name The name of the operation.
+    //! \param p_attributes Key-value pairs for the span attributes.
+    //-------------------------------------------------------------------------
+    CoroutineSpan(CoroutineSpan& p_parent,
+                  const char* p_operation_name,
+                  AttributeList p_attributes = {})
+        : CoroutineSpan(p_parent.m_active,
+                        &p_parent,
+                        p_operation_name,
+                        p_attributes)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief End the span and make active the span it replaced: the
+    //! enclosing span, or the span of the thread running the coroutine.
+    //-------------------------------------------------------------------------
+    ~CoroutineSpan()
+    {
+        end();
+        TraceContext::exchange((m_enclosing != nullptr)
+                                   ? m_enclosing->m_active
+                                   : m_resumer);
+    }
+
+    CoroutineSpan(const CoroutineSpan&) = delete;
+    CoroutineSpan& operator=(const CoroutineSpan&) = delete;
+
+    //-------------------------------------------------------------------------
+    //! \brief Wrap an awaitable so that the span stays attached to the
+    //! coroutine across the suspension: co_await span.wrap(awaitable).
+    //-------------------------------------------------------------------------
+    template <typename Awaitable>
+    Awaiter<Awaitable> wrap(Awaitable&& p_awaitable)
+    {
+        return Awaiter<Awaitable>(*this, std::forward<Awaitable>(p_awaitable));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Add an attribute to the span, if recorded.
+    //-------------------------------------------------------------------------
+    template <typename Value>
+    void addAttribute(const std::string& p_key, Value&& p_value)
+    {
+        if (m_span != nullptr)
+        {
+            m_span->addAttribute(p_key, std::forward<Value>(p_value));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Add an event to the span, if recorded.
+    //-------------------------------------------------------------------------
+    void addEvent(const std::string& p_name, AttributeList p_attributes = {})
+    {
+        if (m_span != nullptr)
+        {
+            m_span->addEvent(p_name, p_attributes);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief End the span before the end of its scope.
+    //-------------------------------------------------------------------------
+    void end()
+    {
+        if (m_span != nullptr)
+        {
+            m_span->end();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the span is recorded (its parent was sampled).
+    //-------------------------------------------------------------------------
+    inline bool isRecording() const
+    {
+        return m_span != nullptr;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the recorded span, or nullptr when nothing is recorded.
+    //-------------------------------------------------------------------------
+    inline Trace* getSpan() const
+    {
+        return m_span.get();
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Start a span child of p_parent if it is sampled, and make it
+    //! the active span. Otherwise p_parent becomes the active span so that
+    //! the nested spans also skip recording.
+    //-------------------------------------------------------------------------
+    CoroutineSpan(Trace* p_parent,
+                  CoroutineSpan* p_enclosing,
+                  const char* p_operation_name,
+                  AttributeList p_attributes)
+        : m_enclosing(p_enclosing),
+          m_outermost((p_enclosing != nullptr) ? p_enclosing->m_outermost
+                                               : this)
+    {
+        if ((p_parent != nullptr) && p_parent->isSampled())
+        {
+            MYLOGGER_ALLOCATION_SCOPE(Trace);
+            m_span = p_parent->createChildSpan(p_operation_name, p_attributes);
+        }
+        m_active = (m_span != nullptr) ? m_span.get() : p_parent;
+        m_resumer = TraceContext::exchange(m_active);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief The coroutine suspends: make active the span of the thread.
+    //-------------------------------------------------------------------------
+    void suspend()
+    {
+        TraceContext::exchange(m_outermost->m_resumer);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief The coroutine resumes: remember the span of the thread and
+    //! make this span active.
+    //-------------------------------------------------------------------------
+    void resume()
+    {
+        m_outermost->m_resumer = TraceContext::exchange(m_active);
+    }
+
+    //! \brief The recorded span (null when nothing is recorded)
+    std::shared_ptr<Trace> m_span;
+    //! \brief Span active while the coroutine runs in this span's scope
+    Trace* m_active;
+    //! \brief Enclosing span of the same coroutine (nullptr if outermost)
+    CoroutineSpan* m_enclosing;
+    //! \brief Outermost span of the coroutine, holding m_resumer
+    CoroutineSpan* m_outermost;
+    //! \brief Span active on the thread before it ran the coroutine (only
+    //! meaningful for the outermost span)
+    Trace* m_resumer;
+};
+
+#endif
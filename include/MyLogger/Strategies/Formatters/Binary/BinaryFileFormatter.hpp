@@ -0,0 +1,79 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/Binary/BinaryLineFormatter.hpp"
+#include "MyLogger/Strategies/LogFileFormatter.hpp"
+
+#include <string>
+
+// *****************************************************************************
+//! \brief File log formatter of the binary encoding (see BinaryEncoder).
+//! The header holds the signature, the encoding version, the service and the
+//! schema of the chunks. The footer marks a cleanly closed session.
+// *****************************************************************************
+class BinaryFileFormatter
+    : public LogFileFormatter<BinaryFileFormatter, BinaryLineFormatter>
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_formatter The line formatter to use.
+    //! \param p_filename The name of the log file.
+    //! \param p_mode The file mode (Append or Create).
+    //-------------------------------------------------------------------------
+    BinaryFileFormatter(BinaryLineFormatter& p_formatter,
+                        const std::string& p_filename,
+                        const FileMode p_mode)
+        : LogFileFormatter<BinaryFileFormatter, BinaryLineFormatter>(
+              p_formatter, p_filename, p_mode)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Create the binary header and reset the string table of the
+    //! line formatter.
+    //-------------------------------------------------------------------------
+    std::string headerImpl()
+    {
+        BinaryLineFormatter& line_formatter = getLineFormatter();
+        line_formatter.resetStringTable();
+
+        std::string os(BinaryEncoder::SIGNATURE,
+                       sizeof(BinaryEncoder::SIGNATURE));
+        os.push_back(static_cast<char>(BinaryEncoder::VERSION));
+        BinaryEncoder::putString(os, line_formatter.getServiceName());
+        BinaryEncoder::putString(os, line_formatter.getServiceVersion());
+
+        // Schema: the fields of each chunk type, for external readers.
+        static const std::pair<char, const char*> schema[] = {
+            { BinaryEncoder::LEVEL, "severity:u8" },
+            { BinaryEncoder::STRING, "index:varint,text:bytes" },
+            { BinaryEncoder::TRACE,
+              "trace_id:id,start:varint,span_count:varint,"
+              "spans[span_id:id,parent_id:id,name:ref,start:svarint,"
+              "duration:varint,attributes[key:ref,value:string],"
+              "tags[key:ref,value:string,type:ref],"
+              "events[name:ref,time:svarint,attributes[key:ref,"
+              "value:string]]]" },
+            { BinaryEncoder::END, "" }
+        };
+        BinaryEncoder::putVarint(os, sizeof(schema) / sizeof(schema[0]));
+        for (const auto& [type, fields] : schema)
+        {
+            os.push_back(type);
+            BinaryEncoder::putString(os, fields);
+        }
+
+        return os;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Create the end chunk.
+    //-------------------------------------------------------------------------
+    std::string footerImpl() const
+    {
+        std::string os;
+        BinaryEncoder::putChunk(os, BinaryEncoder::END, {});
+        return os;
+    }
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/Binary/BinaryProtocol.hpp"
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLevel.hpp"
+#include "MyLogger/Strategies/LogLineFormatter.hpp"
+#include "MyLogger/Strategies/LogTrace.hpp"
+
+#include <string>
+#include <unordered_map>
+
+// *****************************************************************************
+//! \brief Log line formatter producing the compact binary encoding described
+//! in BinaryEncoder: a level chunk, the string definitions the record needs,
+//! then a trace chunk. Pair it with BinaryFileFormatter.
+//!
+//! Strings are interned: each operation name, key or event name is written
+//! once per file. The string table therefore lives in the formatter and all
+//! the records it formats shall reach the same output in the same order,
+//! which the Logger guarantees by formatting under its lock. The formatter
+//! is owned by a single Logger, and the table is reset by the header of its
+//! file formatter. Writers delivering a record to some of their outputs
+//! only (MultiSinkLogWriter filters levels and drops records) reject it at
+//! compile time through HAS_OUTPUT_STATE.
+// *****************************************************************************
+class BinaryLineFormatter : public LogLineFormatter<BinaryLineFormatter>
+{
+public:
+
+    //! \brief Records refer to the strings defined by the previous ones.
+    static constexpr bool HAS_OUTPUT_STATE = true;
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor with service configuration.
+    //-------------------------------------------------------------------------
+    BinaryLineFormatter(const std::string& p_service_name,
+                        const std::string& p_service_version)
+        : m_service_name(p_service_name), m_service_version(p_service_version)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting the beginning of a log line: the
+    //! level chunk.
+    //-------------------------------------------------------------------------
+    std::string
+    formatBeginImpl(LogLevel p_level, bool /*p_is_first_line*/) const
+    {
+        std::string output;
+        BinaryEncoder::putChunk(
+            output,
+            BinaryEncoder::LEVEL,
+            std::string(1u, static_cast<char>(static_cast<uint8_t>(p_level))));
+        return output;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting the middle part: the new strings
+    //! then the trace chunk holding the root span and all its children.
+    //-------------------------------------------------------------------------
+    std::string formatMiddleImpl(const Trace& p_trace) const
+    {
+        return formatTrace(p_trace, true);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting a single span in streaming mode:
+    //! a trace chunk holding this span only.
+    //-------------------------------------------------------------------------
+    std::string formatSpanImpl(const Trace& p_span) const
+    {
+        return formatTrace(p_span, false);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting the end of a log line: records
+    //! are delimited by their chunks.
+    //-------------------------------------------------------------------------
+    std::string formatEndImpl() const
+    {
+        return {};
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Forget the interned strings. Called when a file header is
+    //! written, since readers reset their string table on a header.
+    //-------------------------------------------------------------------------
+    void resetStringTable()
+    {
+        m_strings.clear();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the service name.
+    //-------------------------------------------------------------------------
+    const std::string& getServiceName() const
+    {
+        return m_service_name;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the service version.
+    //-------------------------------------------------------------------------
+    const std::string& getServiceVersion() const
+    {
+        return m_service_version;
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Encode a trace chunk, preceded by the definitions of the
+    //! strings it uses for the first time.
+    //! \param p_trace The root span.
+    //! \param p_with_children Whether the child spans are encoded.
+    //-------------------------------------------------------------------------
+    std::string formatTrace(const Trace& p_trace, bool p_with_children) const
+    {
+        std::string output;
+        std::string payload;
+
+        const uint64_t start = p_trace.getStartTimeNanos();
+        BinaryEncoder::putId(payload, p_trace.getTraceId());
+        BinaryEncoder::putVarint(payload, start);
+        BinaryEncoder::putVarint(payload,
+                                 p_with_children ? countSpans(p_trace) : 1u);
+        appendSpan(output, payload, p_trace, start, p_with_children);
+
+        BinaryEncoder::putChunk(output, BinaryEncoder::TRACE, payload);
+        return output;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Count a span and its children.
+    //-------------------------------------------------------------------------
+    static uint64_t countSpans(const Trace& p_trace)
+    {
+        uint64_t count = 1u;
+        for (const auto& child : p_trace.getChildren())
+        {
+            count += countSpans(*child);
+        }
+        return count;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Encode a span (then its children if requested).
+    //! \param p_strings Receives the new string definitions.
+    //! \param p_payload Receives the span.
+    //! \param p_span The span.
+    //! \param p_trace_start The start time of the trace.
+    //! \param p_with_children Whether the child spans are encoded.
+    //-------------------------------------------------------------------------
+    void appendSpan(std::string& p_strings,
+                    std::string& p_payload,
+                    const Trace& p_span,
+                    uint64_t p_trace_start,
+                    bool p_with_children) const
+    {
+        const uint64_t start = p_span.getStartTimeNanos();
+
+        BinaryEncoder::putId(p_payload, p_span.getSpanId());
+        BinaryEncoder::putId(p_payload, p_span.getParentSpanId());
+        BinaryEncoder::putVarint(
+            p_payload, intern(p_strings, p_span.getOperationName()));
+        BinaryEncoder::putSignedVarint(
+            p_payload, static_cast<int64_t>(start - p_trace_start));
+        BinaryEncoder::putVarint(p_payload, p_span.getDurationNanos());
+
+        appendAttributes(p_strings, p_payload, p_span.getAttributes());
+
+        BinaryEncoder::putVarint(p_payload, p_span.getTags().size());
+        for (const auto& [key, value_type] : p_span.getTags())
+        {
+            BinaryEncoder::putVarint(p_payload, intern(p_strings, key));
+            BinaryEncoder::putString(p_payload, value_type.first);
+            BinaryEncoder::putVarint(p_payload,
+                                     intern(p_strings, value_type.second));
+        }
+
+        BinaryEncoder::putVarint(p_payload, p_span.getEvents().size());
+        for (const auto& event : p_span.getEvents())
+        {
+            BinaryEncoder::putVarint(p_payload, intern(p_strings, event.name));
+            BinaryEncoder::putSignedVarint(
+                p_payload, static_cast<int64_t>(event.timestamp_nanos - start));
+            appendAttributes(p_strings, p_payload, event.attributes);
+        }
+
+        if (p_with_children)
+        {
+            for (const auto& child : p_span.getChildren())
+            {
+                appendSpan(p_strings, p_payload, *child, p_trace_start, true);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Encode attributes: interned keys, inline values.
+    //-------------------------------------------------------------------------
+    void appendAttributes(std::string& p_strings,
+                          std::string& p_payload,
+                          const Trace::Attributes& p_attributes) const
+    {
+        BinaryEncoder::putVarint(p_payload, p_attributes.size());
+        for (const auto& [key, value] : p_attributes)
+        {
+            BinaryEncoder::putVarint(p_payload, intern(p_strings, key));
+            BinaryEncoder::putString(p_payload, value);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the index of a string, appending its definition chunk the
+    //! first time it is seen.
+    //-------------------------------------------------------------------------
+    uint64_t intern(std::string& p_strings, const std::string& p_value) const
+    {
+        auto it = m_strings.find(p_value);
+        if (it != m_strings.end())
+        {
+            return it->second;
+        }
+
+        const uint64_t index = m_strings.size();
+        m_strings.emplace(p_value, index);
+
+        std::string definition;
+        BinaryEncoder::putVarint(definition, index);
+        definition.append(p_value);
+        BinaryEncoder::putChunk(p_strings, BinaryEncoder::STRING, definition);
+        return index;
+    }
+
+    //! \brief Service name written in the file header
+    std::string m_service_name;
+    //! \brief Service version written in the file header
+    std::string m_service_version;
+    //! \brief Interned strings and their index
+    mutable std::unordered_map<std::string, uint64_t> m_strings;
+};
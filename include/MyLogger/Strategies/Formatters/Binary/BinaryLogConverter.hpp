@@ -0,0 +1,416 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/Binary/BinaryProtocol.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// *****************************************************************************
+//! \brief Converter of binary logs (see BinaryEncoder) into the JSON document
+//! written by OpenTelemetryFileFormatter, so that the JSON tooling (viewer,
+//! scripts) reads both formats.
+//!
+//! A log truncated in the middle of a chunk (i.e. after a crash) is converted
+//! up to its last complete chunk.
+// *****************************************************************************
+class BinaryLogConverter
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if a buffer starts with the binary log signature.
+    //-------------------------------------------------------------------------
+    static bool isBinaryLog(const char* p_data, size_t p_size)
+    {
+        return BinaryDecoder(p_data, p_size).atSignature();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Convert a binary log into JSON.
+    //! \param p_data The binary log.
+    //! \param p_size The size of the binary log.
+    //! \param p_json Receives the JSON document.
+    //! \return An empty string on success, else an error message.
+    //-------------------------------------------------------------------------
+    static std::string
+    toJson(const char* p_data, size_t p_size, std::string& p_json)
+    {
+        BinaryDecoder input(p_data, p_size);
+        if (!input.atSignature())
+        {
+            return "Error: not a MyLogger binary log";
+        }
+
+        std::string service;
+        std::vector<std::string> strings;
+        uint8_t severity = 0u;
+        bool first_trace = true;
+
+        p_json = "{ \"traces\": [ ";
+        while (!input.atEnd())
+        {
+            if (input.atSignature())
+            {
+                if (!readHeader(input, service))
+                {
+                    return "Error: corrupted header at offset " +
+                           std::to_string(input.offset());
+                }
+                strings.clear();
+                continue;
+            }
+
+            uint8_t type;
+            uint64_t size;
+            std::string payload;
+            if (!input.byte(type) || !input.varint(size) ||
+                !input.bytes(size, payload))
+            {
+                break; // Truncated log: keep the complete chunks
+            }
+
+            BinaryDecoder chunk(payload.data(), payload.size());
+            switch (type)
+            {
+                case BinaryEncoder::LEVEL:
+                    chunk.byte(severity);
+                    break;
+                case BinaryEncoder::STRING:
+                {
+                    uint64_t index;
+                    std::string text;
+                    if (!chunk.varint(index) ||
+                        !chunk.bytes(payload.size() - chunk.offset(), text) ||
+                        (index != strings.size()))
+                    {
+                        return "Error: corrupted string table";
+                    }
+                    strings.push_back(std::move(text));
+                    break;
+                }
+                case BinaryEncoder::TRACE:
+                {
+                    std::string trace;
+                    if (!readTrace(chunk, strings, service, severity, trace))
+                    {
+                        return "Error: corrupted trace at offset " +
+                               std::to_string(input.offset());
+                    }
+                    p_json += first_trace ? "" : ",";
+                    p_json += trace;
+                    p_json += '\n';
+                    first_trace = false;
+                    break;
+                }
+                default: // END and future chunk types
+                    break;
+            }
+        }
+        p_json += "] }\n";
+
+        return {};
+    }
+
+private:
+
+    //! \brief Decoded span.
+    struct Span
+    {
+        std::string span_id;
+        std::string parent_id;
+        uint64_t start;
+        uint64_t duration;
+        std::string name;
+        std::string json;
+    };
+
+    //! \brief Depth of the decoded spans of a trace, by span ID.
+    using Depths = std::map<std::string, size_t>;
+
+    //-------------------------------------------------------------------------
+    //! \brief Read a file header.
+    //-------------------------------------------------------------------------
+    static bool readHeader(BinaryDecoder& p_input, std::string& p_service)
+    {
+        uint8_t version;
+        std::string service_version;
+        uint64_t chunk_types;
+        if (!p_input.skip(sizeof(BinaryEncoder::SIGNATURE)) ||
+            !p_input.byte(version) || (version != BinaryEncoder::VERSION) ||
+            !p_input.string(p_service) || !p_input.string(service_version) ||
+            !p_input.varint(chunk_types))
+        {
+            return false;
+        }
+
+        // Skip the schema: this reader knows the version it describes.
+        for (uint64_t i = 0u; i < chunk_types; ++i)
+        {
+            uint8_t type;
+            std::string fields;
+            if (!p_input.byte(type) || !p_input.string(fields))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read a string reference.
+    //-------------------------------------------------------------------------
+    static bool readRef(BinaryDecoder& p_input,
+                        const std::vector<std::string>& p_strings,
+                        std::string& p_value)
+    {
+        uint64_t index;
+        if (!p_input.varint(index) || (index >= p_strings.size()))
+        {
+            return false;
+        }
+        p_value = p_strings[index];
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read attributes as a JSON object member (empty if none).
+    //-------------------------------------------------------------------------
+    static bool readAttributes(BinaryDecoder& p_input,
+                               const std::vector<std::string>& p_strings,
+                               std::string& p_json)
+    {
+        uint64_t count;
+        if (!p_input.varint(count))
+        {
+            return false;
+        }
+        if (count == 0u)
+        {
+            return true;
+        }
+
+        p_json += ",\"attributes\":{";
+        for (uint64_t i = 0u; i < count; ++i)
+        {
+            std::string key, value;
+            if (!readRef(p_input, p_strings, key) || !p_input.string(value))
+            {
+                return false;
+            }
+            p_json += (i == 0u) ? "\"" : ",\"";
+            p_json += escape(key) + "\":\"" + escape(value) + "\"";
+        }
+        p_json += "}";
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read a span, formatted as OpenTelemetryLineFormatter does. Spans
+    //! are encoded parents first, so the depth of the parent is known. The
+    //! trace ID is given escaped.
+    //-------------------------------------------------------------------------
+    static bool readSpan(BinaryDecoder& p_input,
+                         const std::vector<std::string>& p_strings,
+                         const std::string& p_trace_id,
+                         const std::string& p_service,
+                         uint64_t p_trace_start,
+                         Depths& p_depths,
+                         Span& p_span)
+    {
+        int64_t start_delta;
+        if (!p_input.id(p_span.span_id) || !p_input.id(p_span.parent_id) ||
+            !readRef(p_input, p_strings, p_span.name) ||
+            !p_input.signedVarint(start_delta) ||
+            !p_input.varint(p_span.duration))
+        {
+            return false;
+        }
+        p_span.start = p_trace_start + static_cast<uint64_t>(start_delta);
+
+        size_t depth = 0u;
+        if (!p_span.parent_id.empty())
+        {
+            auto parent = p_depths.find(p_span.parent_id);
+            depth = (parent != p_depths.end()) ? parent->second + 1u : 1u;
+        }
+        if (!p_span.span_id.empty())
+        {
+            p_depths[p_span.span_id] = depth;
+        }
+
+        std::string& json = p_span.json;
+        json = "\"spanID\":\"" + escape(p_span.span_id) + "\",";
+        if (!p_span.parent_id.empty())
+        {
+            json += "\"traceID\":\"" + p_trace_id + "\",\"parentSpanID\":\"" +
+                    escape(p_span.parent_id) + "\",";
+        }
+        json += "\"operationName\":\"" + escape(p_span.name) + "\",";
+        json += "\"serviceName\":\"" + escape(p_service) + "\",";
+        json += "\"startTime\":" + std::to_string(p_span.start) + ",";
+        json += "\"duration\":" + std::to_string(p_span.duration) + ",";
+        json += "\"depth\":" + std::to_string(depth);
+
+        // Attributes are encoded before the tags but formatted after them.
+        std::string attributes;
+        if (!readAttributes(p_input, p_strings, attributes))
+        {
+            return false;
+        }
+
+        uint64_t tags;
+        if (!p_input.varint(tags))
+        {
+            return false;
+        }
+        if (tags > 0u)
+        {
+            json += ",\"tags\":{";
+            for (uint64_t i = 0u; i < tags; ++i)
+            {
+                std::string key, value, type;
+                if (!readRef(p_input, p_strings, key) ||
+                    !p_input.string(value) ||
+                    !readRef(p_input, p_strings, type))
+                {
+                    return false;
+                }
+                json += (i == 0u) ? "\"" : ",\"";
+                json += escape(key) + "\":{\"value\":\"" + escape(value) +
+                        "\"";
+                if (!type.empty())
+                {
+                    json += ",\"type\":\"" + escape(type) + "\"";
+                }
+                json += "}";
+            }
+            json += "}";
+        }
+        json += attributes;
+
+        uint64_t events;
+        if (!p_input.varint(events))
+        {
+            return false;
+        }
+        if (events > 0u)
+        {
+            json += ",\"events\":[";
+            for (uint64_t i = 0u; i < events; ++i)
+            {
+                std::string event_name;
+                int64_t time_delta;
+                if (!readRef(p_input, p_strings, event_name) ||
+                    !p_input.signedVarint(time_delta))
+                {
+                    return false;
+                }
+                json += (i == 0u) ? "{" : ",{";
+                json += "\"name\":\"" + escape(event_name) +
+                        "\",\"timestamp\":" +
+                        std::to_string(p_span.start +
+                                       static_cast<uint64_t>(time_delta));
+                if (!readAttributes(p_input, p_strings, json))
+                {
+                    return false;
+                }
+                json += "}";
+            }
+            json += "]";
+        }
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read a trace chunk and format it as a JSON trace object.
+    //-------------------------------------------------------------------------
+    static bool readTrace(BinaryDecoder& p_input,
+                          const std::vector<std::string>& p_strings,
+                          const std::string& p_service,
+                          uint8_t p_severity,
+                          std::string& p_json)
+    {
+        std::string trace_id;
+        uint64_t start, count;
+        if (!p_input.id(trace_id) || !p_input.varint(start) ||
+            !p_input.varint(count) || (count == 0u) ||
+            (count > p_input.remaining()))
+        {
+            return false;
+        }
+        trace_id = escape(trace_id);
+
+        std::vector<Span> spans(count);
+        Depths depths;
+        for (auto& span : spans)
+        {
+            if (!readSpan(p_input, p_strings, trace_id, p_service, start,
+                          depths, span))
+            {
+                return false;
+            }
+        }
+
+        const Span& root = spans.front();
+        p_json = "{\"traceID\":\"" + trace_id + "\",";
+        p_json += "\"traceName\":\"" + escape(root.name) + "\",";
+        p_json += "\"severityNumber\":" + std::to_string(p_severity) + ",";
+        p_json += "\"spans\":[";
+        for (size_t i = 0u; i < spans.size(); ++i)
+        {
+            p_json += (i == 0u) ? "{" : ",{";
+            p_json += spans[i].json + "}";
+        }
+        p_json += "],\"startTime\":" + std::to_string(root.start);
+        p_json += ",\"total_duration\":" + std::to_string(root.duration);
+        p_json += ",\"total_spans\":" + std::to_string(spans.size()) + "}";
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Escape a string for a JSON string literal.
+    //-------------------------------------------------------------------------
+    static std::string escape(const std::string& p_value)
+    {
+        std::string output;
+        output.reserve(p_value.size());
+        for (char c : p_value)
+        {
+            switch (c)
+            {
+                case '"':
+                    output += "\\\"";
+                    break;
+                case '\\':
+                    output += "\\\\";
+                    break;
+                case '\n':
+                    output += "\\n";
+                    break;
+                case '\r':
+                    output += "\\r";
+                    break;
+                case '\t':
+                    output += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20u)
+                    {
+                        char hex[8];
+                        std::snprintf(hex, sizeof(hex), "\\u%04x", c);
+                        output += hex;
+                    }
+                    else
+                    {
+                        output += c;
+                    }
+                    break;
+            }
+        }
+        return output;
+    }
+};
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// *****************************************************************************
+//! \brief Encoding shared by the binary formatters and the binary reader.
+//!
+//! A binary log file is a sequence of chunks, each made of a type byte, a
+//! varint payload length and the payload, so that readers skip the chunks
+//! they do not know:
+//! - File header (written once per logging session, also in the middle of a
+//!   file opened in append mode), not a chunk: the SIGNATURE bytes, a
+//!   version byte, the service name and version, then the schema (the
+//!   fields of each chunk type). A header resets the string table.
+//! - 'L' level: one byte, the OpenTelemetry severity of the next trace.
+//! - 'S' string: varint index, then the bytes of the string. Defines the next
+//!   entry of the string table: operation names, attribute keys, tag types
+//!   and event names are written once per file and later referred to by
+//!   index.
+//! - 'T' trace: trace ID, start time, varint span count, then the spans
+//!   (root span first) with their span and parent IDs, the name index, the
+//!   start time (zigzag delta from the trace start), the duration, the
+//!   attributes, tags and events (time as a zigzag delta from the span
+//!   start). Times are nanoseconds since epoch. IDs are raw bytes (see
+//!   putId()): 16 for a trace ID, 8 for a span ID and none for the parent of
+//!   a root span.
+//! - 'E' end: empty, written when the logging session closes cleanly.
+//!
+//! Numbers are LEB128 varints. Values of attributes and tags are inline
+//! strings (varint length then bytes) since they rarely repeat.
+// *****************************************************************************
+class BinaryEncoder
+{
+public:
+
+    //! \brief First bytes of a binary log (not a valid chunk type).
+    static constexpr char SIGNATURE[8] = { '\x89', 'M', 'L', 'B', '\r', '\n',
+                                           '\x1a', '\n' };
+    //! \brief Version of the encoding.
+    static constexpr uint8_t VERSION = 1u;
+
+    //! \brief Chunk types.
+    enum Chunk : char
+    {
+        LEVEL = 'L',
+        STRING = 'S',
+        TRACE = 'T',
+        END = 'E'
+    };
+
+    //-------------------------------------------------------------------------
+    //! \brief Append an unsigned LEB128 varint.
+    //-------------------------------------------------------------------------
+    static void putVarint(std::string& p_output, uint64_t p_value)
+    {
+        while (p_value >= 0x80u)
+        {
+            p_output.push_back(static_cast<char>((p_value & 0x7Fu) | 0x80u));
+            p_value >>= 7;
+        }
+        p_output.push_back(static_cast<char>(p_value));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a signed varint (zigzag encoded).
+    //-------------------------------------------------------------------------
+    static void putSignedVarint(std::string& p_output, int64_t p_value)
+    {
+        putVarint(p_output,
+                  (static_cast<uint64_t>(p_value) << 1) ^
+                      static_cast<uint64_t>(p_value >> 63));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a string prefixed by its varint length.
+    //-------------------------------------------------------------------------
+    static void putString(std::string& p_output, const std::string& p_value)
+    {
+        putVarint(p_output, p_value.size());
+        p_output.append(p_value);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a chunk.
+    //-------------------------------------------------------------------------
+    static void
+    putChunk(std::string& p_output, Chunk p_type, const std::string& p_payload)
+    {
+        p_output.push_back(static_cast<char>(p_type));
+        putString(p_output, p_payload);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a trace or span ID. A lowercase hexadecimal ID is stored
+    //! as raw bytes, any other ID as is, so that an empty ID (root spans have
+    //! no parent, spans not sampled have no span ID) stays distinct from any
+    //! generated ID. The ID is prefixed by a varint holding twice its stored
+    //! size, plus one for an ID stored as is.
+    //-------------------------------------------------------------------------
+    static void putId(std::string& p_output, const std::string& p_id)
+    {
+        if (!isHexId(p_id))
+        {
+            putVarint(p_output, (uint64_t(p_id.size()) << 1) | 1u);
+            p_output.append(p_id);
+            return;
+        }
+
+        putVarint(p_output, uint64_t(p_id.size() / 2u) << 1);
+        for (size_t i = 0u; i < p_id.size(); i += 2u)
+        {
+            p_output.push_back(static_cast<char>((nibble(p_id[i]) << 4) |
+                                                 nibble(p_id[i + 1u])));
+        }
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the value of a lowercase hexadecimal digit.
+    //-------------------------------------------------------------------------
+    static unsigned nibble(char p_digit)
+    {
+        return (p_digit <= '9') ? unsigned(p_digit - '0')
+                                : unsigned(p_digit - 'a' + 10);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if an ID is made of pairs of lowercase hexadecimal
+    //! digits, as generated by Trace.
+    //-------------------------------------------------------------------------
+    static bool isHexId(const std::string& p_id)
+    {
+        if (p_id.size() % 2u != 0u)
+        {
+            return false;
+        }
+        for (char c : p_id)
+        {
+            if (!(((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f'))))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// *****************************************************************************
+//! \brief Bounds-checked cursor reading the encoding of BinaryEncoder.
+//! Every read returns false once the input is exhausted or malformed.
+// *****************************************************************************
+class BinaryDecoder
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_data The encoded bytes (not copied).
+    //! \param p_size The number of encoded bytes.
+    //-------------------------------------------------------------------------
+    BinaryDecoder(const char* p_data, size_t p_size)
+        : m_data(p_data), m_size(p_size)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the whole input has been read.
+    //-------------------------------------------------------------------------
+    bool atEnd() const
+    {
+        return m_offset >= m_size;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of bytes read.
+    //-------------------------------------------------------------------------
+    size_t offset() const
+    {
+        return m_offset;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of bytes left to read.
+    //-------------------------------------------------------------------------
+    size_t remaining() const
+    {
+        return m_size - m_offset;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the next bytes are the file signature.
+    //-------------------------------------------------------------------------
+    bool atSignature() const
+    {
+        constexpr size_t size = sizeof(BinaryEncoder::SIGNATURE);
+        return (m_size - m_offset >= size) &&
+               (std::memcmp(
+                    m_data + m_offset, BinaryEncoder::SIGNATURE, size) == 0);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Skip p_size bytes.
+    //-------------------------------------------------------------------------
+    bool skip(size_t p_size)
+    {
+        if (m_size - m_offset < p_size)
+        {
+            return false;
+        }
+        m_offset += p_size;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read a byte.
+    //-------------------------------------------------------------------------
+    bool byte(uint8_t& p_value)
+    {
+        if (atEnd())
+        {
+            return false;
+        }
+        p_value = static_cast<uint8_t>(m_data[m_offset++]);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read an unsigned LEB128 varint.
+    //-------------------------------------------------------------------------
+    bool varint(uint64_t& p_value)
+    {
+        p_value = 0u;
+        for (unsigned shift = 0u; shift < 64u; shift += 7u)
+        {
+            uint8_t b;
+            if (!byte(b))
+            {
+                return false;
+            }
+            p_value |= uint64_t(b & 0x7Fu) << shift;
+            if ((b & 0x80u) == 0u)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read a zigzag encoded signed varint.
+    //-------------------------------------------------------------------------
+    bool signedVarint(int64_t& p_value)
+    {
+        uint64_t raw;
+        if (!varint(raw))
+        {
+            return false;
+        }
+        p_value =
+            static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1u);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read p_size raw bytes.
+    //-------------------------------------------------------------------------
+    bool bytes(size_t p_size, std::string& p_value)
+    {
+        if (m_size - m_offset < p_size)
+        {
+            return false;
+        }
+        p_value.assign(m_data + m_offset, p_size);
+        m_offset += p_size;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read a string prefixed by its varint length.
+    //-------------------------------------------------------------------------
+    bool string(std::string& p_value)
+    {
+        uint64_t size;
+        return varint(size) && bytes(size, p_value);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read an ID written by BinaryEncoder::putId(), hexadecimal IDs
+    //! back in lowercase.
+    //-------------------------------------------------------------------------
+    bool id(std::string& p_value)
+    {
+        static constexpr char digits[] = "0123456789abcdef";
+        uint64_t header;
+        if (!varint(header) || ((header >> 1) > m_size - m_offset))
+        {
+            return false;
+        }
+        const size_t size = static_cast<size_t>(header >> 1);
+        if ((header & 1u) != 0u)
+        {
+            return bytes(size, p_value);
+        }
+
+        p_value.clear();
+        for (size_t i = 0u; i < size; ++i)
+        {
+            auto b = static_cast<uint8_t>(m_data[m_offset++]);
+            p_value.push_back(digits[b >> 4]);
+            p_value.push_back(digits[b & 0x0Fu]);
+        }
+        return true;
+    }
+
+private:
+
+    //! \brief The encoded bytes
+    const char* m_data;
+    //! \brief The number of encoded bytes
+    size_t m_size;
+    //! \brief The number of bytes read
+    size_t m_offset = 0u;
+};
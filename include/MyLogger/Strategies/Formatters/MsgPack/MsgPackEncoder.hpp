@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// *****************************************************************************
+//! \brief Minimal MessagePack encoder appending to a string. Integers use the
+//! smallest representation, times use the timestamp extension type (-1).
+// *****************************************************************************
+class MsgPackEncoder
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Append nil.
+    //-------------------------------------------------------------------------
+    static void putNil(std::string& p_output)
+    {
+        p_output.push_back(char(0xc0));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a boolean.
+    //-------------------------------------------------------------------------
+    static void putBool(std::string& p_output, bool p_value)
+    {
+        p_output.push_back(p_value ? char(0xc3) : char(0xc2));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append an unsigned integer.
+    //-------------------------------------------------------------------------
+    static void putUint(std::string& p_output, uint64_t p_value)
+    {
+        if (p_value < 0x80u)
+        {
+            p_output.push_back(static_cast<char>(p_value));
+        }
+        else if (p_value <= 0xFFu)
+        {
+            putBigEndian(p_output, 0xcc, p_value, 1u);
+        }
+        else if (p_value <= 0xFFFFu)
+        {
+            putBigEndian(p_output, 0xcd, p_value, 2u);
+        }
+        else if (p_value <= 0xFFFFFFFFu)
+        {
+            putBigEndian(p_output, 0xce, p_value, 4u);
+        }
+        else
+        {
+            putBigEndian(p_output, 0xcf, p_value, 8u);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a signed integer.
+    //-------------------------------------------------------------------------
+    static void putInt(std::string& p_output, int64_t p_value)
+    {
+        if (p_value >= 0)
+        {
+            putUint(p_output, static_cast<uint64_t>(p_value));
+        }
+        else if (p_value >= -32)
+        {
+            p_output.push_back(static_cast<char>(p_value));
+        }
+        else
+        {
+            putBigEndian(p_output, 0xd3, static_cast<uint64_t>(p_value), 8u);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a double.
+    //-------------------------------------------------------------------------
+    static void putDouble(std::string& p_output, double p_value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &p_value, sizeof(bits));
+        putBigEndian(p_output, 0xcb, bits, 8u);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a string.
+    //-------------------------------------------------------------------------
+    static void putString(std::string& p_output, const std::string& p_value)
+    {
+        putString(p_output, p_value.data(), p_value.size());
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a string of p_size bytes.
+    //-------------------------------------------------------------------------
+    static void
+    putString(std::string& p_output, const char* p_value, size_t p_size)
+    {
+        if (p_size < 32u)
+        {
+            p_output.push_back(static_cast<char>(0xa0u | p_size));
+        }
+        else if (p_size <= 0xFFu)
+        {
+            putBigEndian(p_output, 0xd9, p_size, 1u);
+        }
+        else if (p_size <= 0xFFFFu)
+        {
+            putBigEndian(p_output, 0xda, p_size, 2u);
+        }
+        else
+        {
+            putBigEndian(p_output, 0xdb, p_size, 4u);
+        }
+        p_output.append(p_value, p_size);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append the header of an array of p_size elements.
+    //-------------------------------------------------------------------------
+    static void putArray(std::string& p_output, size_t p_size)
+    {
+        putContainer(p_output, 0x90u, 0xdc, p_size);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append the header of a map of p_size key/value pairs.
+    //-------------------------------------------------------------------------
+    static void putMap(std::string& p_output, size_t p_size)
+    {
+        putContainer(p_output, 0x80u, 0xde, p_size);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a timestamp (extension type -1).
+    //! \param p_nanos Nanoseconds since epoch.
+    //-------------------------------------------------------------------------
+    static void putTimestamp(std::string& p_output, uint64_t p_nanos)
+    {
+        const uint64_t seconds = p_nanos / 1000000000u;
+        const uint64_t nanos = p_nanos % 1000000000u;
+
+        if ((seconds >> 34) == 0u)
+        {
+            // timestamp 64: 30-bit nanoseconds and 34-bit seconds
+            putBigEndian(p_output, 0xd7, 0xFFu, 1u);
+            putBigEndian(p_output, (nanos << 34) | seconds, 8u);
+        }
+        else
+        {
+            // timestamp 96: 32-bit nanoseconds and 64-bit seconds
+            putBigEndian(p_output, 0xc7, 12u, 1u);
+            p_output.push_back(char(0xff));
+            putBigEndian(p_output, nanos, 4u);
+            putBigEndian(p_output, seconds, 8u);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a value given as a string, typed by its type name:
+    //! "int"/"int64", "uint"/"uint64", "double"/"float64", "bool" or else a
+    //! string. Values not matching their type are kept as strings.
+    //-------------------------------------------------------------------------
+    static void putTyped(std::string& p_output,
+                         const std::string& p_value,
+                         const std::string& p_type)
+    {
+        const char* begin = p_value.c_str();
+        char* end = nullptr;
+
+        if (!p_value.empty())
+        {
+            if ((p_type == "int") || (p_type == "int64"))
+            {
+                long long value = std::strtoll(begin, &end, 10);
+                if (*end == '\0')
+                {
+                    putInt(p_output, value);
+                    return;
+                }
+            }
+            else if ((p_type == "uint") || (p_type == "uint64"))
+            {
+                unsigned long long value = std::strtoull(begin, &end, 10);
+                if ((*end == '\0') && (p_value[0] != '-'))
+                {
+                    putUint(p_output, value);
+                    return;
+                }
+            }
+            else if ((p_type == "double") || (p_type == "float64"))
+            {
+                double value = std::strtod(begin, &end);
+                if (*end == '\0')
+                {
+                    putDouble(p_output, value);
+                    return;
+                }
+            }
+            else if (p_type == "bool")
+            {
+                if ((p_value == "true") || (p_value == "false"))
+                {
+                    putBool(p_output, p_value == "true");
+                    return;
+                }
+            }
+        }
+
+        putString(p_output, p_value);
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Append an array or map header.
+    //-------------------------------------------------------------------------
+    static void putContainer(std::string& p_output,
+                             unsigned p_fix,
+                             int p_marker16,
+                             size_t p_size)
+    {
+        if (p_size < 16u)
+        {
+            p_output.push_back(static_cast<char>(p_fix | p_size));
+        }
+        else if (p_size <= 0xFFFFu)
+        {
+            putBigEndian(p_output, p_marker16, p_size, 2u);
+        }
+        else
+        {
+            // The 32-bit marker follows the 16-bit one.
+            putBigEndian(p_output, p_marker16 + 1, p_size, 4u);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a marker byte then p_bytes bytes of p_value.
+    //-------------------------------------------------------------------------
+    static void putBigEndian(std::string& p_output,
+                             int p_marker,
+                             uint64_t p_value,
+                             size_t p_bytes)
+    {
+        p_output.push_back(static_cast<char>(p_marker));
+        putBigEndian(p_output, p_value, p_bytes);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append p_bytes bytes of p_value, most significant first.
+    //-------------------------------------------------------------------------
+    static void
+    putBigEndian(std::string& p_output, uint64_t p_value, size_t p_bytes)
+    {
+        for (size_t i = p_bytes; i > 0u; --i)
+        {
+            p_output.push_back(static_cast<char>(p_value >> (8u * (i - 1u))));
+        }
+    }
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/MsgPack/MsgPackLineFormatter.hpp"
+#include "MyLogger/Strategies/LogFileFormatter.hpp"
+
+#include <string>
+
+// *****************************************************************************
+//! \brief File log formatter of MsgPackLineFormatter. A stream of MessagePack
+//! records has neither header nor footer, so sessions appended to the same
+//! file stay readable.
+// *****************************************************************************
+class MsgPackFileFormatter
+    : public LogFileFormatter<MsgPackFileFormatter, MsgPackLineFormatter>
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_formatter The line formatter to use.
+    //! \param p_filename The name of the log file.
+    //! \param p_mode The file mode (Append or Create).
+    //-------------------------------------------------------------------------
+    MsgPackFileFormatter(MsgPackLineFormatter& p_formatter,
+                         const std::string& p_filename,
+                         const FileMode p_mode)
+        : LogFileFormatter<MsgPackFileFormatter, MsgPackLineFormatter>(
+              p_formatter, p_filename, p_mode)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief No header.
+    //-------------------------------------------------------------------------
+    std::string headerImpl() const
+    {
+        return {};
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief No footer.
+    //-------------------------------------------------------------------------
+    std::string footerImpl() const
+    {
+        return {};
+    }
+};
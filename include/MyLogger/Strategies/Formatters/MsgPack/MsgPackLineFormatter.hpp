@@ -0,0 +1,247 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/MsgPack/MsgPackEncoder.hpp"
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLevel.hpp"
+#include "MyLogger/Strategies/LogLineFormatter.hpp"
+#include "MyLogger/Strategies/LogTrace.hpp"
+
+#include <string>
+
+// *****************************************************************************
+//! \brief Log line formatter producing one MessagePack map per record, with
+//! the keys of the OpenTelemetry JSON formatter: {traceID, traceName, spans,
+//! startTime, total_duration, total_spans}. Records are concatenated without
+//! separator (MessagePack values are self-delimiting).
+//!
+//! The whole map is the middle part of the record, so that the writers
+//! sending only the middle part (socket writers, the severity going in the
+//! frame header) send maps that decode.
+//!
+//! Values are typed: times are MessagePack timestamps (extension type -1),
+//! durations and depths are integers in nanoseconds, tag values are encoded
+//! according to their type (see MsgPackEncoder::putTyped()). Attribute
+//! values are strings.
+// *****************************************************************************
+class MsgPackLineFormatter : public LogLineFormatter<MsgPackLineFormatter>
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor with service configuration.
+    //-------------------------------------------------------------------------
+    MsgPackLineFormatter(const std::string& p_service_name,
+                         const std::string& p_service_version)
+        : m_service_name(p_service_name), m_service_version(p_service_version)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting the beginning of a log line:
+    //! nothing, the record map is the middle part.
+    //-------------------------------------------------------------------------
+    std::string formatBeginImpl(LogLevel /*p_level*/,
+                                bool /*p_is_first_line*/) const
+    {
+        return {};
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting the middle part: the record map
+    //! with the root span and all its children.
+    //-------------------------------------------------------------------------
+    std::string formatMiddleImpl(const Trace& p_trace) const
+    {
+        return formatTrace(p_trace, true);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting a single span in streaming mode:
+    //! a record holding this span only.
+    //-------------------------------------------------------------------------
+    std::string formatSpanImpl(const Trace& p_span) const
+    {
+        return formatTrace(p_span, false);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting the end of a log line: nothing.
+    //-------------------------------------------------------------------------
+    std::string formatEndImpl() const
+    {
+        return {};
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the service name.
+    //-------------------------------------------------------------------------
+    const std::string& getServiceName() const
+    {
+        return m_service_name;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the service version.
+    //-------------------------------------------------------------------------
+    const std::string& getServiceVersion() const
+    {
+        return m_service_version;
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a map key given as a string literal.
+    //-------------------------------------------------------------------------
+    template <size_t N>
+    static void putKey(std::string& p_output, const char (&p_key)[N])
+    {
+        MsgPackEncoder::putString(p_output, p_key, N - 1u);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Encode the record map.
+    //! \param p_trace The root span.
+    //! \param p_with_children Whether the child spans are encoded.
+    //-------------------------------------------------------------------------
+    std::string formatTrace(const Trace& p_trace, bool p_with_children) const
+    {
+        const size_t spans = p_with_children ? countSpans(p_trace) : 1u;
+
+        std::string output;
+        output.reserve(128u + 160u * spans);
+
+        MsgPackEncoder::putMap(output, 6u);
+        putKey(output, "traceID");
+        MsgPackEncoder::putString(output, p_trace.getTraceId());
+        putKey(output, "traceName");
+        MsgPackEncoder::putString(output, p_trace.getOperationName());
+        putKey(output, "spans");
+        MsgPackEncoder::putArray(output, spans);
+        appendSpan(output, p_trace, 0u, p_with_children);
+        putKey(output, "startTime");
+        MsgPackEncoder::putTimestamp(output, p_trace.getStartTimeNanos());
+        putKey(output, "total_duration");
+        MsgPackEncoder::putUint(output, p_trace.getDurationNanos());
+        putKey(output, "total_spans");
+        MsgPackEncoder::putUint(output, spans);
+
+        return output;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Count a span and its descendants.
+    //-------------------------------------------------------------------------
+    static size_t countSpans(const Trace& p_trace)
+    {
+        size_t count = 1u;
+        for (const auto& child : p_trace.getChildren())
+        {
+            count += countSpans(*child);
+        }
+        return count;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Encode a span map (then its descendants if requested).
+    //-------------------------------------------------------------------------
+    void appendSpan(std::string& p_output,
+                    const Trace& p_span,
+                    size_t p_depth,
+                    bool p_with_children) const
+    {
+        const bool is_child = !p_span.getParentSpanId().empty();
+        const auto& tags = p_span.getTags();
+        const auto& attributes = p_span.getAttributes();
+        const auto& events = p_span.getEvents();
+
+        MsgPackEncoder::putMap(p_output,
+                               6u + (is_child ? 2u : 0u) +
+                                   (tags.empty() ? 0u : 1u) +
+                                   (attributes.empty() ? 0u : 1u) +
+                                   (events.empty() ? 0u : 1u));
+        putKey(p_output, "spanID");
+        MsgPackEncoder::putString(p_output, p_span.getSpanId());
+        if (is_child)
+        {
+            putKey(p_output, "traceID");
+            MsgPackEncoder::putString(p_output, p_span.getTraceId());
+            putKey(p_output, "parentSpanID");
+            MsgPackEncoder::putString(p_output, p_span.getParentSpanId());
+        }
+        putKey(p_output, "operationName");
+        MsgPackEncoder::putString(p_output, p_span.getOperationName());
+        putKey(p_output, "serviceName");
+        MsgPackEncoder::putString(p_output, m_service_name);
+        putKey(p_output, "startTime");
+        MsgPackEncoder::putTimestamp(p_output, p_span.getStartTimeNanos());
+        putKey(p_output, "duration");
+        MsgPackEncoder::putUint(p_output, p_span.getDurationNanos());
+        putKey(p_output, "depth");
+        MsgPackEncoder::putUint(p_output, (is_child && (p_depth == 0u))
+                                              ? 1u
+                                              : p_depth);
+
+        if (!tags.empty())
+        {
+            putKey(p_output, "tags");
+            MsgPackEncoder::putMap(p_output, tags.size());
+            for (const auto& [key, value_type] : tags)
+            {
+                MsgPackEncoder::putString(p_output, key);
+                MsgPackEncoder::putTyped(
+                    p_output, value_type.first, value_type.second);
+            }
+        }
+        if (!attributes.empty())
+        {
+            putKey(p_output, "attributes");
+            appendAttributes(p_output, attributes);
+        }
+        if (!events.empty())
+        {
+            putKey(p_output, "events");
+            MsgPackEncoder::putArray(p_output, events.size());
+            for (const auto& event : events)
+            {
+                MsgPackEncoder::putMap(p_output,
+                                       event.attributes.empty() ? 2u : 3u);
+                putKey(p_output, "name");
+                MsgPackEncoder::putString(p_output, event.name);
+                putKey(p_output, "timestamp");
+                MsgPackEncoder::putTimestamp(p_output, event.timestamp_nanos);
+                if (!event.attributes.empty())
+                {
+                    putKey(p_output, "attributes");
+                    appendAttributes(p_output, event.attributes);
+                }
+            }
+        }
+
+        if (p_with_children)
+        {
+            for (const auto& child : p_span.getChildren())
+            {
+                appendSpan(p_output, *child, p_depth + 1u, true);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Encode attributes as a map of strings.
+    //-------------------------------------------------------------------------
+    static void appendAttributes(std::string& p_output,
+                                 const Trace::Attributes& p_attributes)
+    {
+        MsgPackEncoder::putMap(p_output, p_attributes.size());
+        for (const auto& [key, value] : p_attributes)
+        {
+            MsgPackEncoder::putString(p_output, key);
+            MsgPackEncoder::putString(p_output, value);
+        }
+    }
+
+    //! \brief Service name of the spans
+    std::string m_service_name;
+    //! \brief Service version
+    std::string m_service_version;
+};
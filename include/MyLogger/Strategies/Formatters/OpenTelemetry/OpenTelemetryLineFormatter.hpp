@@ -4,12 +4,15 @@
 #include "MyLogger/Strategies/LogLineFormatter.hpp"
 #include "MyLogger/Strategies/LogTrace.hpp"
 
+#include <cstdio>
+#include <ostream>
 #include <sstream>
 
 // *****************************************************************************
 //! \brief Log line formatter that generates viewer-compatible OpenTelemetry
 //! JSON. This formatter creates trace entries with embedded spans for direct
-//! viewer compatibility.
+//! viewer compatibility. Names, keys and values are escaped as JSON string
+//! literals.
 // *****************************************************************************
 class OpenTelemetryLineFormatter
     : public LogLineFormatter<OpenTelemetryLineFormatter>
@@ -31,7 +34,7 @@ public:
     std::string formatBeginImpl(LogLevel /*p_level*/,
                                 bool p_is_first_line) const
     {
-        return p_is_first_line ? "" : ",";
+        return (p_is_first_line || m_newline_delimited) ? "" : ",";
     }
 
     //-------------------------------------------------------------------------
@@ -43,8 +46,8 @@ public:
         std::ostringstream os;
 
         os << "{";
-        os << "\"traceID\":\"" << p_trace.getTraceId() << "\","
-           << "\"traceName\":\"" << p_trace.getOperationName() << "\","
+        os << "\"traceID\":\"" << Json{ p_trace.getTraceId() } << "\","
+           << "\"traceName\":\"" << Json{ p_trace.getOperationName() } << "\","
            << "\"spans\":[" << formatAllSpans(p_trace) << "]"
            << "," << formatTraceMetadata(p_trace);
         os << "}";
@@ -52,6 +55,27 @@ public:
         return os.str();
     }
 
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting a single span in streaming mode.
+    //! The span is emitted as a trace holding one span, which carries the
+    //! trace and parent span IDs to rebuild the tree.
+    //-------------------------------------------------------------------------
+    std::string formatSpanImpl(const Trace& p_span) const
+    {
+        std::ostringstream os;
+
+        os << "{";
+        os << "\"traceID\":\"" << Json{ p_span.getTraceId() } << "\","
+           << "\"traceName\":\"" << Json{ p_span.getOperationName() } << "\","
+           << "\"spans\":[" << formatSpanObject(p_span) << "],"
+           << "\"startTime\":" << p_span.getStartTimeNanos() << ","
+           << "\"total_duration\":" << p_span.getDurationNanos() << ","
+           << "\"total_spans\":1";
+        os << "}";
+
+        return os.str();
+    }
+
     //-------------------------------------------------------------------------
     //! \brief Implementation for formatting the end of a log line.
     //-------------------------------------------------------------------------
@@ -60,6 +84,16 @@ public:
         return "\n";
     }
 
+    //-------------------------------------------------------------------------
+    //! \brief Select the newline-delimited layout (one self-contained trace
+    //! object per line) instead of the elements of a JSON array. Set by
+    //! OpenTelemetryNdjsonFileFormatter.
+    //-------------------------------------------------------------------------
+    void setNewlineDelimited(bool p_enable)
+    {
+        m_newline_delimited = p_enable;
+    }
+
 private:
 
     //-------------------------------------------------------------------------
@@ -70,7 +104,7 @@ private:
         std::ostringstream os;
 
         // Format the main span
-        os << formatSpan(p_trace);
+        os << formatSpanObject(p_trace);
 
         // Format all child spans
         const auto& children = p_trace.getChildren();
@@ -85,7 +119,7 @@ private:
     //-------------------------------------------------------------------------
     //! \brief Format a single span with all its properties.
     //-------------------------------------------------------------------------
-    std::string formatSpan(const Trace& p_trace) const
+    std::string formatSpanObject(const Trace& p_trace) const
     {
         std::ostringstream os;
 
@@ -106,16 +140,19 @@ private:
         std::ostringstream os;
 
         // Main span data in viewer format
-        os << "\"spanID\":\"" << p_trace.getSpanId() << "\",";
+        os << "\"spanID\":\"" << Json{ p_trace.getSpanId() } << "\",";
 
-        // Add parent span ID (traceID) if any
+        // Add the trace and parent span IDs of child spans
         if (!p_trace.getParentSpanId().empty())
         {
-            os << "\"traceID\":\"" << p_trace.getParentSpanId() << "\",";
+            os << "\"traceID\":\"" << Json{ p_trace.getTraceId() } << "\","
+               << "\"parentSpanID\":\"" << Json{ p_trace.getParentSpanId() }
+               << "\",";
         }
 
-        os << "\"operationName\":\"" << p_trace.getOperationName() << "\","
-           << "\"serviceName\":\"" << m_service_name << "\","
+        os << "\"operationName\":\"" << Json{ p_trace.getOperationName() }
+           << "\","
+           << "\"serviceName\":\"" << Json{ m_service_name } << "\","
            << "\"startTime\":" << p_trace.getStartTimeNanos() << ","
            << "\"duration\":" << p_trace.getDurationNanos() << ",";
 
@@ -140,11 +177,11 @@ private:
         os << ",\"tags\":{";
         for (const auto& [key, value_pair] : p_tags)
         {
-            os << separator << "\"" << key << "\":{";
-            os << "\"value\":\"" << value_pair.first << "\",";
+            os << separator << "\"" << Json{ key } << "\":{";
+            os << "\"value\":\"" << Json{ value_pair.first } << "\",";
             if (!value_pair.second.empty())
             {
-                os << "\"type\":\"" << value_pair.second << "\"";
+                os << "\"type\":\"" << Json{ value_pair.second } << "\"";
             }
             os << "}";
             separator = ",";
@@ -168,7 +205,8 @@ private:
         os << ",\"attributes\":{";
         for (const auto& [key, value] : p_attributes)
         {
-            os << separator << "\"" << key << "\":\"" << value << "\"";
+            os << separator << "\"" << Json{ key } << "\":\"" << Json{ value }
+               << "\"";
             separator = ",";
         }
         os << "}";
@@ -190,7 +228,7 @@ private:
         os << ",\"events\":[";
         for (const auto& event : p_events)
         {
-            os << separator << "{\"name\":\"" << event.name
+            os << separator << "{\"name\":\"" << Json{ event.name }
                << "\",\"timestamp\":" << event.timestamp_nanos
                << formatAttributes(event.attributes);
             os << "}";
@@ -218,6 +256,61 @@ private:
 
 private:
 
+    // *************************************************************************
+    //! \brief String written escaped for a JSON string literal.
+    // *************************************************************************
+    struct Json
+    {
+        const std::string& value;
+
+        friend std::ostream& operator<<(std::ostream& p_os, const Json& p_json)
+        {
+            const std::string& value = p_json.value;
+            size_t written = 0u;
+            for (size_t i = 0u; i < value.size(); ++i)
+            {
+                const auto c = static_cast<unsigned char>(value[i]);
+                if ((c >= 0x20u) && (c != '"') && (c != '\\'))
+                {
+                    continue;
+                }
+
+                p_os.write(value.data() + written,
+                           static_cast<std::streamsize>(i - written));
+                written = i + 1u;
+                switch (c)
+                {
+                    case '"':
+                        p_os << "\\\"";
+                        break;
+                    case '\\':
+                        p_os << "\\\\";
+                        break;
+                    case '\n':
+                        p_os << "\\n";
+                        break;
+                    case '\r':
+                        p_os << "\\r";
+                        break;
+                    case '\t':
+                        p_os << "\\t";
+                        break;
+                    default:
+                    {
+                        char hex[8];
+                        std::snprintf(hex, sizeof(hex), "\\u%04x", c);
+                        p_os << hex;
+                        break;
+                    }
+                }
+            }
+            return p_os.write(value.data() + written,
+                              static_cast<std::streamsize>(value.size() -
+                                                           written));
+        }
+    };
+
     std::string m_service_name;
     std::string m_service_version;
+    bool m_newline_delimited = false;
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLineFormatter.hpp"
+#include "MyLogger/Strategies/LogFileFormatter.hpp"
+
+#include <string>
+
+// *****************************************************************************
+//! \brief File log formatter of the newline-delimited JSON layout (NDJSON):
+//! one self-contained trace object per line, without enclosing document.
+//!
+//! Unlike OpenTelemetryFileFormatter, every complete line stays parseable when
+//! the process crashes, sessions appended to the same file (FileMode::Append)
+//! give a valid file, several processes can append to the same file without
+//! sharing a lock (as long as their writer appends whole lines) and readers
+//! can tail the file or parse its lines in parallel.
+//! The viewer loads both layouts.
+// *****************************************************************************
+class OpenTelemetryNdjsonFileFormatter
+    : public LogFileFormatter<OpenTelemetryNdjsonFileFormatter,
+                              OpenTelemetryLineFormatter>
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor. Switches the line formatter to the
+    //! newline-delimited layout.
+    //! \param p_formatter The line formatter to use.
+    //! \param p_filename The name of the log file.
+    //! \param p_mode The file mode (Append or Create).
+    //-------------------------------------------------------------------------
+    OpenTelemetryNdjsonFileFormatter(OpenTelemetryLineFormatter& p_formatter,
+                                     const std::string& p_filename,
+                                     const FileMode p_mode)
+        : LogFileFormatter<OpenTelemetryNdjsonFileFormatter,
+                           OpenTelemetryLineFormatter>(p_formatter,
+                                                       p_filename,
+                                                       p_mode)
+    {
+        p_formatter.setNewlineDelimited(true);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief No header: lines are self-contained.
+    //-------------------------------------------------------------------------
+    std::string headerImpl() const
+    {
+        return {};
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief No footer: lines are self-contained.
+    //-------------------------------------------------------------------------
+    std::string footerImpl() const
+    {
+        return {};
+    }
+};
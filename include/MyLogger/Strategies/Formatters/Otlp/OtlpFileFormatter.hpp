@@ -0,0 +1,46 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/Otlp/OtlpLineFormatter.hpp"
+#include "MyLogger/Strategies/LogFileFormatter.hpp"
+
+#include <string>
+
+// *****************************************************************************
+//! \brief File log formatter of OtlpLineFormatter. A stream of OTLP requests
+//! has neither header nor footer.
+// *****************************************************************************
+class OtlpFileFormatter
+    : public LogFileFormatter<OtlpFileFormatter, OtlpLineFormatter>
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_formatter The line formatter to use.
+    //! \param p_filename The name of the log file.
+    //! \param p_mode The file mode (Append or Create).
+    //-------------------------------------------------------------------------
+    OtlpFileFormatter(OtlpLineFormatter& p_formatter,
+                      const std::string& p_filename,
+                      const FileMode p_mode)
+        : LogFileFormatter<OtlpFileFormatter, OtlpLineFormatter>(
+              p_formatter, p_filename, p_mode)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief No header.
+    //-------------------------------------------------------------------------
+    std::string headerImpl() const
+    {
+        return {};
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief No footer.
+    //-------------------------------------------------------------------------
+    std::string footerImpl() const
+    {
+        return {};
+    }
+};
@@ -0,0 +1,326 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLevel.hpp"
+#include "MyLogger/Strategies/Formatters/Otlp/OtlpProtocol.hpp"
+#include "MyLogger/Strategies/LogLineFormatter.hpp"
+#include "MyLogger/Strategies/LogTrace.hpp"
+
+#include <string>
+
+// *****************************************************************************
+//! \brief Log line formatter producing OTLP protobuf: each record is an
+//! ExportTraceServiceRequest holding the service resource, one scope and the
+//! spans of the trace (root span first, children flattened after it), so
+//! that a collector decodes it without parsing JSON.
+//!
+//! Protobuf messages are not self-delimiting: by default each record is
+//! prefixed by its varint length (as protobuf writeDelimitedTo() does) so
+//! records can be read back from a file. Writers framing their records
+//! themselves (i.e. SocketLogWriter) can disable the prefix.
+//!
+//! Tags are encoded as string attributes. The encoder sizes the message then
+//! writes it into the returned string: one allocation per record.
+// *****************************************************************************
+class OtlpLineFormatter : public LogLineFormatter<OtlpLineFormatter>
+{
+public:
+
+    //! \brief Instrumentation scope name written in each request.
+    static constexpr const char* INSTRUMENTATION_SCOPE = "MyLogger";
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor with service configuration.
+    //! \param p_service_name The service.name resource attribute.
+    //! \param p_service_version The service.version resource attribute.
+    //! \param p_length_delimited Prefix each record by its varint length.
+    //-------------------------------------------------------------------------
+    OtlpLineFormatter(const std::string& p_service_name,
+                      const std::string& p_service_version,
+                      bool p_length_delimited = true)
+        : m_service_name(p_service_name),
+          m_service_version(p_service_version),
+          m_length_delimited(p_length_delimited)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting the beginning of a log line:
+    //! nothing, OTLP spans have no severity.
+    //-------------------------------------------------------------------------
+    std::string formatBeginImpl(LogLevel /*p_level*/,
+                                bool /*p_is_first_line*/) const
+    {
+        return {};
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting the middle part: the request
+    //! holding the root span and all its children.
+    //-------------------------------------------------------------------------
+    std::string formatMiddleImpl(const Trace& p_trace) const
+    {
+        return formatRequest(p_trace, true);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting a single span in streaming mode:
+    //! a request holding this span only.
+    //-------------------------------------------------------------------------
+    std::string formatSpanImpl(const Trace& p_span) const
+    {
+        return formatRequest(p_span, false);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Implementation for formatting the end of a log line: nothing.
+    //-------------------------------------------------------------------------
+    std::string formatEndImpl() const
+    {
+        return {};
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the service name.
+    //-------------------------------------------------------------------------
+    const std::string& getServiceName() const
+    {
+        return m_service_name;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the service version.
+    //-------------------------------------------------------------------------
+    const std::string& getServiceVersion() const
+    {
+        return m_service_version;
+    }
+
+private:
+
+    using W = ProtobufWriter;
+    using F = OtlpField;
+
+    //-------------------------------------------------------------------------
+    //! \brief Encode an ExportTraceServiceRequest.
+    //! \param p_trace The root span.
+    //! \param p_with_children Whether the child spans are encoded.
+    //-------------------------------------------------------------------------
+    std::string formatRequest(const Trace& p_trace, bool p_with_children) const
+    {
+        static const std::string scope_name(INSTRUMENTATION_SCOPE);
+
+        const size_t resource_size = resourceSize();
+        const size_t scope_size =
+            W::lengthDelimitedSize(F::SCOPE_NAME, scope_name.size());
+        const size_t scope_spans_size =
+            W::lengthDelimitedSize(F::SCOPE_SPANS_SCOPE, scope_size) +
+            spansSize(p_trace, p_with_children);
+        const size_t resource_spans_size =
+            W::lengthDelimitedSize(F::RESOURCE_SPANS_RESOURCE, resource_size) +
+            W::lengthDelimitedSize(F::RESOURCE_SPANS_SCOPE_SPANS,
+                                   scope_spans_size);
+        const size_t request_size = W::lengthDelimitedSize(
+            F::REQUEST_RESOURCE_SPANS, resource_spans_size);
+        const size_t total_size =
+            m_length_delimited
+                ? W::varintSize(request_size) + request_size
+                : request_size;
+
+        std::string output(total_size, '\0');
+        W writer(output.data());
+        if (m_length_delimited)
+        {
+            writer.varint(request_size);
+        }
+        writer.message(F::REQUEST_RESOURCE_SPANS, resource_spans_size);
+        writer.message(F::RESOURCE_SPANS_RESOURCE, resource_size);
+        writeKeyValue(writer, F::RESOURCE_ATTRIBUTES, SERVICE_NAME_KEY,
+                      m_service_name);
+        writeKeyValue(writer, F::RESOURCE_ATTRIBUTES, SERVICE_VERSION_KEY,
+                      m_service_version);
+        writer.message(F::RESOURCE_SPANS_SCOPE_SPANS, scope_spans_size);
+        writer.message(F::SCOPE_SPANS_SCOPE, scope_size);
+        writer.string(F::SCOPE_NAME, scope_name);
+        writeSpans(writer, p_trace, p_with_children);
+
+        return output;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the size of the Resource message.
+    //-------------------------------------------------------------------------
+    size_t resourceSize() const
+    {
+        return W::lengthDelimitedSize(
+                   F::RESOURCE_ATTRIBUTES,
+                   keyValueSize(SERVICE_NAME_KEY, m_service_name)) +
+               W::lengthDelimitedSize(
+                   F::RESOURCE_ATTRIBUTES,
+                   keyValueSize(SERVICE_VERSION_KEY, m_service_version));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the size of the spans fields of ScopeSpans: a span and
+    //! (if requested) its descendants.
+    //-------------------------------------------------------------------------
+    static size_t spansSize(const Trace& p_span, bool p_with_children)
+    {
+        size_t size =
+            W::lengthDelimitedSize(F::SCOPE_SPANS_SPANS, spanSize(p_span));
+        if (p_with_children)
+        {
+            for (const auto& child : p_span.getChildren())
+            {
+                size += spansSize(*child, true);
+            }
+        }
+        return size;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the spans fields of ScopeSpans in the order of
+    //! spansSize().
+    //-------------------------------------------------------------------------
+    static void
+    writeSpans(W& p_writer, const Trace& p_span, bool p_with_children)
+    {
+        p_writer.message(F::SCOPE_SPANS_SPANS, spanSize(p_span));
+        writeSpan(p_writer, p_span);
+        if (p_with_children)
+        {
+            for (const auto& child : p_span.getChildren())
+            {
+                writeSpans(p_writer, *child, true);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the size of a Span message (without its children).
+    //-------------------------------------------------------------------------
+    static size_t spanSize(const Trace& p_span)
+    {
+        size_t size =
+            W::lengthDelimitedSize(F::SPAN_TRACE_ID, F::TRACE_ID_SIZE) +
+            W::lengthDelimitedSize(F::SPAN_SPAN_ID, F::SPAN_ID_SIZE) +
+            W::lengthDelimitedSize(F::SPAN_NAME,
+                                   p_span.getOperationName().size()) +
+            W::fixed64Size(F::SPAN_START_TIME) +
+            W::fixed64Size(F::SPAN_END_TIME);
+        if (!p_span.getParentSpanId().empty())
+        {
+            size +=
+                W::lengthDelimitedSize(F::SPAN_PARENT_SPAN_ID, F::SPAN_ID_SIZE);
+        }
+        for (const auto& [key, value] : p_span.getAttributes())
+        {
+            size += W::lengthDelimitedSize(F::SPAN_ATTRIBUTES,
+                                           keyValueSize(key, value));
+        }
+        for (const auto& [key, value_type] : p_span.getTags())
+        {
+            size += W::lengthDelimitedSize(
+                F::SPAN_ATTRIBUTES, keyValueSize(key, value_type.first));
+        }
+        for (const auto& event : p_span.getEvents())
+        {
+            size += W::lengthDelimitedSize(F::SPAN_EVENTS, eventSize(event));
+        }
+        return size;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the fields of a Span message in the order of spanSize().
+    //-------------------------------------------------------------------------
+    static void writeSpan(W& p_writer, const Trace& p_span)
+    {
+        const uint64_t start = p_span.getStartTimeNanos();
+
+        p_writer.hexBytes(F::SPAN_TRACE_ID, p_span.getTraceId(),
+                          F::TRACE_ID_SIZE);
+        p_writer.hexBytes(F::SPAN_SPAN_ID, p_span.getSpanId(),
+                          F::SPAN_ID_SIZE);
+        if (!p_span.getParentSpanId().empty())
+        {
+            p_writer.hexBytes(F::SPAN_PARENT_SPAN_ID,
+                              p_span.getParentSpanId(), F::SPAN_ID_SIZE);
+        }
+        p_writer.string(F::SPAN_NAME, p_span.getOperationName());
+        p_writer.fixed64(F::SPAN_START_TIME, start);
+        p_writer.fixed64(F::SPAN_END_TIME, start + p_span.getDurationNanos());
+        for (const auto& [key, value] : p_span.getAttributes())
+        {
+            writeKeyValue(p_writer, F::SPAN_ATTRIBUTES, key, value);
+        }
+        for (const auto& [key, value_type] : p_span.getTags())
+        {
+            writeKeyValue(p_writer, F::SPAN_ATTRIBUTES, key, value_type.first);
+        }
+        for (const auto& event : p_span.getEvents())
+        {
+            p_writer.message(F::SPAN_EVENTS, eventSize(event));
+            p_writer.fixed64(F::EVENT_TIME, event.timestamp_nanos);
+            p_writer.string(F::EVENT_NAME, event.name);
+            for (const auto& [key, value] : event.attributes)
+            {
+                writeKeyValue(p_writer, F::EVENT_ATTRIBUTES, key, value);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the size of a Span.Event message.
+    //-------------------------------------------------------------------------
+    static size_t eventSize(const Event& p_event)
+    {
+        size_t size = W::fixed64Size(F::EVENT_TIME) +
+                      W::lengthDelimitedSize(F::EVENT_NAME,
+                                             p_event.name.size());
+        for (const auto& [key, value] : p_event.attributes)
+        {
+            size += W::lengthDelimitedSize(F::EVENT_ATTRIBUTES,
+                                           keyValueSize(key, value));
+        }
+        return size;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the size of a KeyValue message holding a string.
+    //-------------------------------------------------------------------------
+    static size_t keyValueSize(const std::string& p_key,
+                               const std::string& p_value)
+    {
+        return W::lengthDelimitedSize(F::KEY_VALUE_KEY, p_key.size()) +
+               W::lengthDelimitedSize(
+                   F::KEY_VALUE_VALUE,
+                   W::lengthDelimitedSize(F::ANY_VALUE_STRING,
+                                          p_value.size()));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write a KeyValue field holding a string.
+    //-------------------------------------------------------------------------
+    static void writeKeyValue(W& p_writer,
+                              uint32_t p_field,
+                              const std::string& p_key,
+                              const std::string& p_value)
+    {
+        p_writer.message(p_field, keyValueSize(p_key, p_value));
+        p_writer.string(F::KEY_VALUE_KEY, p_key);
+        p_writer.message(
+            F::KEY_VALUE_VALUE,
+            W::lengthDelimitedSize(F::ANY_VALUE_STRING, p_value.size()));
+        p_writer.string(F::ANY_VALUE_STRING, p_value);
+    }
+
+    //! \brief Keys of the resource attributes
+    static inline const std::string SERVICE_NAME_KEY = "service.name";
+    static inline const std::string SERVICE_VERSION_KEY = "service.version";
+
+    //! \brief Service name of the resource
+    std::string m_service_name;
+    //! \brief Service version of the resource
+    std::string m_service_version;
+    //! \brief Prefix each record by its varint length
+    bool m_length_delimited;
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// *****************************************************************************
+//! \brief Field numbers of the OTLP trace messages used by OtlpLineFormatter
+//! (opentelemetry/proto/collector/trace/v1/trace_service.proto and
+//! opentelemetry/proto/trace/v1/trace.proto).
+// *****************************************************************************
+struct OtlpField
+{
+    //! \brief ExportTraceServiceRequest
+    static constexpr uint32_t REQUEST_RESOURCE_SPANS = 1u;
+    //! \brief ResourceSpans
+    static constexpr uint32_t RESOURCE_SPANS_RESOURCE = 1u;
+    static constexpr uint32_t RESOURCE_SPANS_SCOPE_SPANS = 2u;
+    //! \brief Resource
+    static constexpr uint32_t RESOURCE_ATTRIBUTES = 1u;
+    //! \brief ScopeSpans
+    static constexpr uint32_t SCOPE_SPANS_SCOPE = 1u;
+    static constexpr uint32_t SCOPE_SPANS_SPANS = 2u;
+    //! \brief InstrumentationScope
+    static constexpr uint32_t SCOPE_NAME = 1u;
+    //! \brief Span
+    static constexpr uint32_t SPAN_TRACE_ID = 1u;
+    static constexpr uint32_t SPAN_SPAN_ID = 2u;
+    static constexpr uint32_t SPAN_PARENT_SPAN_ID = 4u;
+    static constexpr uint32_t SPAN_NAME = 5u;
+    static constexpr uint32_t SPAN_START_TIME = 7u;
+    static constexpr uint32_t SPAN_END_TIME = 8u;
+    static constexpr uint32_t SPAN_ATTRIBUTES = 9u;
+    static constexpr uint32_t SPAN_EVENTS = 11u;
+    //! \brief Span.Event
+    static constexpr uint32_t EVENT_TIME = 1u;
+    static constexpr uint32_t EVENT_NAME = 2u;
+    static constexpr uint32_t EVENT_ATTRIBUTES = 3u;
+    //! \brief KeyValue
+    static constexpr uint32_t KEY_VALUE_KEY = 1u;
+    static constexpr uint32_t KEY_VALUE_VALUE = 2u;
+    //! \brief AnyValue
+    static constexpr uint32_t ANY_VALUE_STRING = 1u;
+
+    //! \brief Size of the binary trace ID.
+    static constexpr size_t TRACE_ID_SIZE = 16u;
+    //! \brief Size of the binary span ID.
+    static constexpr size_t SPAN_ID_SIZE = 8u;
+};
+
+// *****************************************************************************
+//! \brief Protobuf wire encoder writing into a caller-provided buffer. It never
+//! allocates: the caller sizes the buffer with the static *Size() methods
+//! (nested messages are length-prefixed, so their size must be known before
+//! they are written) then writes the fields in the same order.
+// *****************************************************************************
+class ProtobufWriter
+{
+public:
+
+    //! \brief Protobuf wire types.
+    enum WireType : uint32_t
+    {
+        VARINT = 0u,
+        FIXED64 = 1u,
+        LENGTH_DELIMITED = 2u
+    };
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_buffer The output buffer, large enough for what is written.
+    //-------------------------------------------------------------------------
+    explicit ProtobufWriter(char* p_buffer)
+        : m_begin(p_buffer), m_cursor(p_buffer)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of bytes written.
+    //-------------------------------------------------------------------------
+    size_t size() const
+    {
+        return static_cast<size_t>(m_cursor - m_begin);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the size of a varint.
+    //-------------------------------------------------------------------------
+    static constexpr size_t varintSize(uint64_t p_value)
+    {
+        size_t size = 1u;
+        while (p_value >= 0x80u)
+        {
+            p_value >>= 7;
+            ++size;
+        }
+        return size;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the size of a length-delimited field (string, bytes or
+    //! nested message) whose content has p_size bytes.
+    //-------------------------------------------------------------------------
+    static constexpr size_t lengthDelimitedSize(uint32_t p_field, size_t p_size)
+    {
+        return varintSize(p_field << 3) + varintSize(p_size) + p_size;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the size of a fixed64 field.
+    //-------------------------------------------------------------------------
+    static constexpr size_t fixed64Size(uint32_t p_field)
+    {
+        return varintSize(p_field << 3) + 8u;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write a varint.
+    //-------------------------------------------------------------------------
+    void varint(uint64_t p_value)
+    {
+        while (p_value >= 0x80u)
+        {
+            *m_cursor++ = static_cast<char>((p_value & 0x7Fu) | 0x80u);
+            p_value >>= 7;
+        }
+        *m_cursor++ = static_cast<char>(p_value);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write a field key.
+    //-------------------------------------------------------------------------
+    void key(uint32_t p_field, WireType p_type)
+    {
+        varint((p_field << 3) | p_type);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write a fixed64 field (little endian).
+    //-------------------------------------------------------------------------
+    void fixed64(uint32_t p_field, uint64_t p_value)
+    {
+        key(p_field, FIXED64);
+        for (unsigned i = 0u; i < 8u; ++i)
+        {
+            *m_cursor++ = static_cast<char>(p_value >> (8u * i));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the key and the length of a nested message. Its fields
+    //! shall be written next.
+    //-------------------------------------------------------------------------
+    void message(uint32_t p_field, size_t p_size)
+    {
+        key(p_field, LENGTH_DELIMITED);
+        varint(p_size);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write a string field.
+    //-------------------------------------------------------------------------
+    void string(uint32_t p_field, const std::string& p_value)
+    {
+        message(p_field, p_value.size());
+        for (char c : p_value)
+        {
+            *m_cursor++ = c;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write a hexadecimal ID as a bytes field of p_size bytes. Missing
+    //! or invalid digits are encoded as zeros.
+    //-------------------------------------------------------------------------
+    void hexBytes(uint32_t p_field, const std::string& p_hex, size_t p_size)
+    {
+        message(p_field, p_size);
+        for (size_t i = 0u; i < p_size; ++i)
+        {
+            unsigned byte = 0u;
+            if (2u * i + 1u < p_hex.size())
+            {
+                byte = (nibble(p_hex[2u * i]) << 4) |
+                       nibble(p_hex[2u * i + 1u]);
+            }
+            *m_cursor++ = static_cast<char>(byte);
+        }
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Convert a hexadecimal digit.
+    //-------------------------------------------------------------------------
+    static unsigned nibble(char p_digit)
+    {
+        if ((p_digit >= '0') && (p_digit <= '9'))
+            return unsigned(p_digit - '0');
+        if ((p_digit >= 'a') && (p_digit <= 'f'))
+            return unsigned(p_digit - 'a' + 10);
+        if ((p_digit >= 'A') && (p_digit <= 'F'))
+            return unsigned(p_digit - 'A' + 10);
+        return 0u;
+    }
+
+    //! \brief Start of the output buffer
+    char* m_begin;
+    //! \brief Next byte to write
+    char* m_cursor;
+};
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// *****************************************************************************
+//! \brief Lock-free latency histogram with log-linear buckets (HDR histogram
+//! layout).
+//!
+//! Values below 2^SUB_BUCKET_BITS are recorded exactly. Above, each power of
+//! two is split into 2^SUB_BUCKET_BITS linear sub-buckets, so any recorded
+//! value is known within 1/2^SUB_BUCKET_BITS (1.6 %) over the whole uint64_t
+//! range with a fixed number of buckets. record() is a few relaxed atomic
+//! increments: threads can record concurrently without lock and without
+//! allocating. Reading while recording gives an approximate but consistent
+//! enough view for reports.
+//!
+//! Values are unit-less; MyLogger records nanoseconds.
+// *****************************************************************************
+class LatencyHistogram
+{
+public:
+
+    //! \brief Number of bits of the linear sub-buckets of a power of two.
+    static constexpr unsigned SUB_BUCKET_BITS = 6u;
+    //! \brief Number of linear sub-buckets of a power of two.
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    //! \brief Number of buckets covering the uint64_t range.
+    static constexpr size_t BUCKETS = (64u - SUB_BUCKET_BITS + 1u) *
+                                      SUB_BUCKETS;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    //-------------------------------------------------------------------------
+    //! \brief Record a value. Thread-safe, lock-free.
+    //-------------------------------------------------------------------------
+    void record(uint64_t p_value)
+    {
+        m_buckets[bucketIndex(p_value)].fetch_add(1u,
+                                                  std::memory_order_relaxed);
+        m_count.fetch_add(1u, std::memory_order_relaxed);
+        m_sum.fetch_add(p_value, std::memory_order_relaxed);
+        updateMin(p_value);
+        updateMax(p_value);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Add the values recorded by another histogram.
+    //-------------------------------------------------------------------------
+    void merge(const LatencyHistogram& p_other)
+    {
+        for (size_t i = 0u; i < BUCKETS; ++i)
+        {
+            const uint64_t count =
+                p_other.m_buckets[i].load(std::memory_order_relaxed);
+            if (count > 0u)
+            {
+                m_buckets[i].fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+        m_count.fetch_add(p_other.count(), std::memory_order_relaxed);
+        m_sum.fetch_add(p_other.sum(), std::memory_order_relaxed);
+        if (p_other.count() > 0u)
+        {
+            updateMin(p_other.min());
+            updateMax(p_other.max());
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Forget the recorded values. Not atomic with regard to
+    //! concurrent record() calls.
+    //-------------------------------------------------------------------------
+    void reset()
+    {
+        for (auto& bucket : m_buckets)
+        {
+            bucket.store(0u, std::memory_order_relaxed);
+        }
+        m_count.store(0u, std::memory_order_relaxed);
+        m_sum.store(0u, std::memory_order_relaxed);
+        m_min.store(std::numeric_limits<uint64_t>::max(),
+                    std::memory_order_relaxed);
+        m_max.store(0u, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of recorded values.
+    //-------------------------------------------------------------------------
+    uint64_t count() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the sum of the recorded values.
+    //-------------------------------------------------------------------------
+    uint64_t sum() const
+    {
+        return m_sum.load(std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the smallest recorded value (0 if none).
+    //-------------------------------------------------------------------------
+    uint64_t min() const
+    {
+        return (count() == 0u) ? 0u : m_min.load(std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the largest recorded value (0 if none).
+    //-------------------------------------------------------------------------
+    uint64_t max() const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the mean of the recorded values (0 if none).
+    //-------------------------------------------------------------------------
+    double mean() const
+    {
+        const uint64_t values = count();
+        return (values == 0u) ? 0.0
+                              : static_cast<double>(sum()) /
+                                    static_cast<double>(values);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the value below which p_percentile percents of the recorded
+    //! values fall, rounded up to the end of its bucket and bounded by max().
+    //! \param p_percentile Percentile in [0, 100].
+    //! \return 0 if no value has been recorded.
+    //-------------------------------------------------------------------------
+    uint64_t percentile(double p_percentile) const
+    {
+        uint64_t total = 0u;
+        for (const auto& bucket : m_buckets)
+        {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        if (total == 0u)
+        {
+            return 0u;
+        }
+
+        const double clamped = std::min(100.0, std::max(0.0, p_percentile));
+        const auto rank = std::max<uint64_t>(
+            1u,
+            static_cast<uint64_t>(clamped / 100.0 *
+                                      static_cast<double>(total) +
+                                  0.5));
+        uint64_t seen = 0u;
+        for (size_t i = 0u; i < BUCKETS; ++i)
+        {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+            {
+                return std::min(bucketUpperBound(i), max());
+            }
+        }
+        return max();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Index of the bucket holding a value.
+    //-------------------------------------------------------------------------
+    static size_t bucketIndex(uint64_t p_value)
+    {
+        if (p_value < SUB_BUCKETS)
+        {
+            return p_value;
+        }
+
+        // The SUB_BUCKET_BITS bits following the most significant bit
+        // select the sub-bucket.
+        unsigned msb = 63u;
+        while ((p_value >> msb) == 0u)
+        {
+            --msb;
+        }
+        const unsigned shift = msb - SUB_BUCKET_BITS;
+        return (shift + 1u) * SUB_BUCKETS + ((p_value >> shift) - SUB_BUCKETS);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Smallest value of a bucket.
+    //-------------------------------------------------------------------------
+    static uint64_t bucketLowerBound(size_t p_index)
+    {
+        if (p_index < 2u * SUB_BUCKETS)
+        {
+            return p_index;
+        }
+        const size_t shift = p_index / SUB_BUCKETS - 1u;
+        return (SUB_BUCKETS + p_index % SUB_BUCKETS) << shift;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Largest value of a bucket.
+    //-------------------------------------------------------------------------
+    static uint64_t bucketUpperBound(size_t p_index)
+    {
+        if (p_index < 2u * SUB_BUCKETS)
+        {
+            return p_index;
+        }
+        const size_t shift = p_index / SUB_BUCKETS - 1u;
+        return bucketLowerBound(p_index) + ((uint64_t(1) << shift) - 1u);
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Lower the minimum to p_value if needed.
+    //-------------------------------------------------------------------------
+    void updateMin(uint64_t p_value)
+    {
+        uint64_t current = m_min.load(std::memory_order_relaxed);
+        while ((p_value < current) &&
+               !m_min.compare_exchange_weak(
+                   current, p_value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Raise the maximum to p_value if needed.
+    //-------------------------------------------------------------------------
+    void updateMax(uint64_t p_value)
+    {
+        uint64_t current = m_max.load(std::memory_order_relaxed);
+        while ((p_value > current) &&
+               !m_max.compare_exchange_weak(
+                   current, p_value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    //! \brief Number of values per bucket
+    std::atomic<uint64_t> m_buckets[BUCKETS] = {};
+    //! \brief Number of recorded values
+    std::atomic<uint64_t> m_count{ 0u };
+    //! \brief Sum of the recorded values
+    std::atomic<uint64_t> m_sum{ 0u };
+    //! \brief Smallest recorded value
+    std::atomic<uint64_t> m_min{ std::numeric_limits<uint64_t>::max() };
+    //! \brief Largest recorded value
+    std::atomic<uint64_t> m_max{ 0u };
+};
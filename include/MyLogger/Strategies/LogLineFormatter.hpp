@@ -1,5 +1,7 @@
 #pragma once
 
+#include "MyLogger/Strategies/AllocationTracker.hpp"
+
 #include <string>
 
 // Forward declarations
@@ -17,6 +19,12 @@ class LogLineFormatter
 {
 public:
 
+    //! \brief Whether a record refers to state written by the records
+    //! formatted before it (i.e. an interned string table), so that every
+    //! record shall reach the single output of the formatter. Derived
+    //! formatters with such state shadow it with true.
+    static constexpr bool HAS_OUTPUT_STATE = false;
+
     //-------------------------------------------------------------------------
     //! \brief Format the beginning of a log line.
     //! \param p_level The log level.
@@ -24,12 +32,28 @@ public:
     //-------------------------------------------------------------------------
     std::string formatBegin(LogLevel p_level) const
     {
+        MYLOGGER_ALLOCATION_SCOPE(LineFormatter);
         bool is_first_line = m_is_first_line;
         m_is_first_line = false;
         return static_cast<const Derived*>(this)->formatBeginImpl(
             p_level, is_first_line);
     }
 
+    //-------------------------------------------------------------------------
+    //! \brief Format the beginning of a log line without touching the first
+    //! line state. For writers dispatching a record to several outputs, each
+    //! output tracking its own first line (i.e. MultiSinkLogWriter).
+    //! \param p_level The log level.
+    //! \param p_is_first_line Whether this is the first line of the output.
+    //! \return The formatted beginning string.
+    //-------------------------------------------------------------------------
+    std::string formatBegin(LogLevel p_level, bool p_is_first_line) const
+    {
+        MYLOGGER_ALLOCATION_SCOPE(LineFormatter);
+        return static_cast<const Derived*>(this)->formatBeginImpl(
+            p_level, p_is_first_line);
+    }
+
     //-------------------------------------------------------------------------
     //! \brief Format the middle part with trace data.
     //! \param p_trace The trace containing log data.
@@ -37,15 +61,29 @@ public:
     //-------------------------------------------------------------------------
     std::string formatMiddle(const Trace& p_trace) const
     {
+        MYLOGGER_ALLOCATION_SCOPE(LineFormatter);
         return static_cast<const Derived*>(this)->formatMiddleImpl(p_trace);
     }
 
+    //-------------------------------------------------------------------------
+    //! \brief Format the middle part with a single span, without its child
+    //! spans (streaming mode, see Trace::setSpanExporter()).
+    //! \param p_span The ended span.
+    //! \return The formatted middle string.
+    //-------------------------------------------------------------------------
+    std::string formatSpan(const Trace& p_span) const
+    {
+        MYLOGGER_ALLOCATION_SCOPE(LineFormatter);
+        return static_cast<const Derived*>(this)->formatSpanImpl(p_span);
+    }
+
     //-------------------------------------------------------------------------
     //! \brief Format the end of a log line.
     //! \return The formatted end string.
     //-------------------------------------------------------------------------
     std::string formatEnd() const
     {
+        MYLOGGER_ALLOCATION_SCOPE(LineFormatter);
         return static_cast<const Derived*>(this)->formatEndImpl();
     }
 
@@ -1,13 +1,20 @@
 #pragma once
 
+#include "MyLogger/Strategies/AllocationTracker.hpp"
+#include "MyLogger/Strategies/SpanList.hpp"
+#include "MyLogger/Strategies/SpanPool.hpp"
+
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <initializer_list>
-#include <iomanip>
 #include <map>
 #include <memory>
 #include <random>
-#include <sstream>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // *****************************************************************************
@@ -32,6 +39,28 @@ struct Event
 // *****************************************************************************
 //! \brief Simple trace structure containing basic trace data.
 //! This is a lightweight structure without external dependencies.
+//!
+//! Child spans share the trace ID of their root and refer to the span ID of
+//! their parent. A trace can be marked as not sampled (see HeadSampler):
+//! attributes, events and tags are then ignored and child spans inherit the
+//! decision without being attached to their parent, so that a sampled-out
+//! trace costs little more than the sampling decision. A root whose decision
+//! was not taken at creation records everything, and the decision is taken
+//! when it is logged.
+//!
+//! Child spans can be created concurrently by several threads (i.e. tasks
+//! of a request fanned out to a thread pool): they are appended without
+//! lock (see SpanList). Attributes, events and tags of a span shall be set
+//! by one thread at a time.
+//!
+//! Attributes costly to compute can be given as callables (see
+//! addAttribute()): they are only invoked when the trace is formatted, that
+//! is once it passed the sampling, rate limiting and level filtering.
+//!
+//! By default a trace holds its child spans until it is logged as a whole.
+//! In streaming mode (see setSpanExporter()), each span is instead handed to
+//! an exporter as soon as it ends and child spans are not kept by their
+//! parent, bounding the memory used by long-running traces.
 // *****************************************************************************
 class Trace
 {
@@ -39,6 +68,10 @@ public:
 
     using Attributes = std::map<std::string, std::string>;
     using Tags = std::map<std::string, std::pair<std::string, std::string>>;
+    //! \brief Callable receiving the spans of a streamed trace when they end.
+    using SpanExporter = std::function<void(const Trace&)>;
+    //! \brief Callable computing the value of an attribute.
+    using LazyAttribute = std::function<std::string()>;
 
     //-------------------------------------------------------------------------
     //! \brief Constructor for root trace.
@@ -50,6 +83,7 @@ public:
                        p_attributes = {})
         : m_operation_name(p_operation_name)
     {
+        MYLOGGER_ALLOCATION_SCOPE(Trace);
         m_start_time_nanos = getCurrentTimeNanos();
         m_trace_id = generateTraceId();
         m_span_id = generateSpanId();
@@ -60,7 +94,8 @@ public:
     }
 
     //-------------------------------------------------------------------------
-    //! \brief Constructor for child trace/span.
+    //! \brief Constructor for child trace/span. The span is not attached to
+    //! the parent: use createChildSpan() for that.
     //! \param p_parent The parent trace.
     //! \param p_operation_name The name of this span operation.
     //! \param p_attributes Key-value pairs for the trace attributes.
@@ -70,18 +105,24 @@ public:
           std::initializer_list<std::pair<const char*, const char*>>
               p_attributes = {})
         : m_operation_name(p_operation_name),
-          m_trace_id(generateTraceId()),
-          m_span_id(generateSpanId()),
-          m_parent_trace_id(p_parent.m_trace_id)
+          m_trace_id(p_parent.m_trace_id),
+          m_parent_span_id(p_parent.m_span_id),
+          m_exporter(p_parent.m_exporter),
+          m_sampled(p_parent.m_sampled),
+          m_sampling_decided(p_parent.m_sampling_decided)
     {
+        MYLOGGER_ALLOCATION_SCOPE(Trace);
         m_start_time_nanos = getCurrentTimeNanos();
+        if (!m_sampled)
+        {
+            return;
+        }
+
+        m_span_id = generateSpanId();
         for (const auto& [key, value] : p_attributes)
         {
             m_attributes[key] = value;
         }
-
-        // Add this span to parent's children
-        p_parent.m_children.push_back(std::make_shared<Trace>(*this));
     }
 
     //-------------------------------------------------------------------------
@@ -101,6 +142,12 @@ public:
                   std::initializer_list<std::pair<const char*, const char*>>
                       p_attributes = {})
     {
+        if (!m_sampled)
+        {
+            return;
+        }
+
+        MYLOGGER_ALLOCATION_SCOPE(Trace);
         auto event_time = getCurrentTimeNanos();
         Attributes attributes;
         for (const auto& [key, value] : p_attributes)
@@ -119,7 +166,44 @@ public:
     inline void addAttribute(const std::string& p_key,
                              const std::string& p_value)
     {
-        m_attributes[p_key] = p_value;
+        if (m_sampled)
+        {
+            MYLOGGER_ALLOCATION_SCOPE(Trace);
+            if (!m_lazy_attributes.empty())
+            {
+                eraseLazyAttribute(p_key);
+            }
+            m_attributes[p_key] = p_value;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Add an attribute whose value is computed only if the trace is
+    //! formatted (i.e. serialized request bodies, stack summaries). The
+    //! callable is invoked once, by the writer right before the first
+    //! formatting of the trace (see resolveAttributes()), which happens on
+    //! the thread calling Logger::log() and under the logger lock, whatever
+    //! the writer: MultiSinkLogWriter also formats the record there and only
+    //! queues the result to its sink threads. The callable shall
+    //! therefore be cheap enough for the logging thread and only capture data
+    //! outliving the trace. Never invoked for traces not sampled, suppressed
+    //! by the rate limiter or below the level of the writer.
+    //! \param p_key The attribute key.
+    //! \param p_compute Callable returning the attribute value.
+    //-------------------------------------------------------------------------
+    template <typename Callable,
+              typename = std::enable_if_t<
+                  std::is_invocable_r_v<std::string, Callable&>>>
+    void addAttribute(const std::string& p_key, Callable&& p_compute)
+    {
+        if (m_sampled)
+        {
+            MYLOGGER_ALLOCATION_SCOPE(Trace);
+            eraseLazyAttribute(p_key);
+            m_lazy_attributes.emplace_back(
+                p_key, LazyAttribute(std::forward<Callable>(p_compute)));
+            m_lazy_state.store(LazyState::Pending, std::memory_order_release);
+        }
     }
 
     //-------------------------------------------------------------------------
@@ -132,11 +216,15 @@ public:
                        const std::string& p_value,
                        const std::string& p_value_type = {})
     {
-        m_tags[p_key] = std::make_pair(p_value, p_value_type);
+        if (m_sampled)
+        {
+            MYLOGGER_ALLOCATION_SCOPE(Trace);
+            m_tags[p_key] = std::make_pair(p_value, p_value_type);
+        }
     }
 
     //-------------------------------------------------------------------------
-    //! \brief End this trace/span.
+    //! \brief End this trace/span. In streaming mode, the span is exported.
     //-------------------------------------------------------------------------
     void end()
     {
@@ -144,6 +232,10 @@ public:
         {
             m_end_time_nanos = getCurrentTimeNanos();
             m_ended = true;
+            if (m_exporter && m_sampled)
+            {
+                (*m_exporter)(*this);
+            }
         }
     }
 
@@ -164,7 +256,9 @@ public:
     }
 
     //-------------------------------------------------------------------------
-    //! \brief Create a child span.
+    //! \brief Create a child span. Thread-safe: several threads can create
+    //! child spans of the same span at once. The span and its reference
+    //! counts share a block recycled by the SpanPool of the calling thread.
     //! \param operation_name The name of the operation for the child span.
     //! \param p_attributes Key-value pairs for the trace attributes.
     //! \return A new child trace/span.
@@ -174,12 +268,68 @@ public:
                     std::initializer_list<std::pair<const char*, const char*>>
                         p_attributes = {})
     {
+        MYLOGGER_ALLOCATION_SCOPE(Trace);
         auto child =
-            std::make_shared<Trace>(*this, p_operation_name, p_attributes);
-        m_children.push_back(child);
+            std::allocate_shared<Trace>(SpanAllocator<Trace>(), *this,
+                                        p_operation_name, p_attributes);
+        if (m_sampled && !m_exporter)
+        {
+            m_children.append(child);
+        }
         return child;
     }
 
+    //-------------------------------------------------------------------------
+    //! \brief Switch to streaming mode: this span and the child spans created
+    //! afterwards are handed to the exporter when they end, instead of being
+    //! kept in this trace. Shall be called on a root trace before creating
+    //! its child spans.
+    //! \param p_exporter The exporter (i.e. Logger::spanExporter()). It shall
+    //! outlive the spans.
+    //-------------------------------------------------------------------------
+    void setSpanExporter(SpanExporter p_exporter)
+    {
+        m_exporter =
+            std::make_shared<const SpanExporter>(std::move(p_exporter));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the spans of this trace are exported when they end.
+    //-------------------------------------------------------------------------
+    inline bool isStreaming() const
+    {
+        return m_exporter != nullptr;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Set the sampling decision. Shall be called on a root trace
+    //! before its child spans are created, which inherit the decision.
+    //! \param p_sampled false to record nothing more for this trace.
+    //-------------------------------------------------------------------------
+    inline void setSampled(bool p_sampled)
+    {
+        m_sampled = p_sampled;
+        m_sampling_decided = true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the trace is recorded. Until the sampling decision is
+    //! taken (see isSamplingDecided()), every trace is recorded.
+    //-------------------------------------------------------------------------
+    inline bool isSampled() const
+    {
+        return m_sampled;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the sampling decision has been stored on the trace
+    //! (on its root for a child span) with setSampled().
+    //-------------------------------------------------------------------------
+    inline bool isSamplingDecided() const
+    {
+        return m_sampling_decided;
+    }
+
     //-------------------------------------------------------------------------
     //! \brief Check if trace is ended.
     //-------------------------------------------------------------------------
@@ -209,7 +359,7 @@ public:
     //-------------------------------------------------------------------------
     const std::string& getParentSpanId() const
     {
-        return m_parent_trace_id;
+        return m_parent_span_id;
     }
 
     //-------------------------------------------------------------------------
@@ -245,17 +395,43 @@ public:
     }
 
     //-------------------------------------------------------------------------
-    //! \brief Get all attributes.
+    //! \brief Get all attributes, including the attributes given as
+    //! callables (computed here if no writer did it yet, see
+    //! resolveAttributes()).
     //-------------------------------------------------------------------------
     const Attributes& getAttributes() const
     {
+        resolveAttributes(false);
         return m_attributes;
     }
 
     //-------------------------------------------------------------------------
-    //! \brief Get all child spans.
+    //! \brief Compute the attributes given as callables, once. Called by the
+    //! writers under the logger lock before formatting the trace, so that
+    //! formatters only read the attributes. Thread-safe: a thread reaching a
+    //! trace being resolved by another one waits for its values.
+    //! \param p_with_children Whether the attributes of the child spans are
+    //! computed too.
+    //-------------------------------------------------------------------------
+    void resolveAttributes(bool p_with_children) const
+    {
+        if (m_lazy_state.load(std::memory_order_acquire) != LazyState::None)
+        {
+            resolveLazyAttributes();
+        }
+        if (p_with_children)
+        {
+            for (const auto& child : m_children)
+            {
+                child->resolveAttributes(true);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get all child spans, in the order they were created.
     //-------------------------------------------------------------------------
-    const std::vector<std::shared_ptr<Trace>>& getChildren() const
+    const SpanList& getChildren() const
     {
         return m_children;
     }
@@ -286,17 +462,10 @@ private:
     //-------------------------------------------------------------------------
     static std::string generateTraceId()
     {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<uint32_t> dis(0, 0xFFFFFFFF);
-
-        std::ostringstream oss;
-        oss << std::hex << std::setfill('0');
-        for (int i = 0; i < 4; ++i)
-        {
-            oss << std::setw(8) << dis(gen);
-        }
-        return oss.str();
+        std::string id(32u, '0');
+        writeHex(&id[0], nextRandom());
+        writeHex(&id[16], nextRandom());
+        return id;
     }
 
     //-------------------------------------------------------------------------
@@ -304,21 +473,121 @@ private:
     //-------------------------------------------------------------------------
     static std::string generateSpanId()
     {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<uint32_t> dis(0, 0xFFFFFFFF);
+        std::string id(16u, '0');
+        writeHex(&id[0], nextRandom());
+        return id;
+    }
 
-        std::ostringstream oss;
-        oss << std::hex << std::setfill('0');
-        for (int i = 0; i < 2; ++i)
+    //-------------------------------------------------------------------------
+    //! \brief Get the next number of the splitmix64 generator of the calling
+    //! thread, seeded by std::random_device when the thread draws its first
+    //! ID. Threads do not share the generator, so that IDs cost a few
+    //! multiplications and no lock. Not reseeded by fork(): a child process
+    //! shall not create spans from a thread that created spans before the
+    //! fork.
+    //-------------------------------------------------------------------------
+    static uint64_t nextRandom()
+    {
+        thread_local uint64_t state =
+            (uint64_t(std::random_device{}()) << 32) ^ std::random_device{}();
+
+        uint64_t z = (state += 0x9E3779B97F4A7C15u);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+        return z ^ (z >> 31);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write a number as 16 lowercase hexadecimal digits.
+    //-------------------------------------------------------------------------
+    static void writeHex(char* p_output, uint64_t p_value)
+    {
+        static constexpr char digits[] = "0123456789abcdef";
+        for (int i = 15; i >= 0; --i)
         {
-            oss << std::setw(8) << dis(gen);
+            p_output[i] = digits[p_value & 0x0Fu];
+            p_value >>= 4;
         }
-        return oss.str();
     }
 
 private:
 
+    //! \brief Resolution state of the lazy attributes.
+    enum class LazyState : uint8_t
+    {
+        None,      //!< No lazy attribute to compute
+        Pending,   //!< Lazy attributes wait for resolveAttributes()
+        Resolving  //!< A thread is computing them
+    };
+
+    // *************************************************************************
+    //! \brief Atomic LazyState copied with the trace, so that traces stay
+    //! copyable. A trace shall not be copied while being formatted.
+    // *************************************************************************
+    struct AtomicLazyState : std::atomic<LazyState>
+    {
+        AtomicLazyState() : std::atomic<LazyState>(LazyState::None)
+        {
+        }
+
+        AtomicLazyState(const AtomicLazyState& p_other)
+            : std::atomic<LazyState>(p_other.load(std::memory_order_acquire))
+        {
+        }
+
+        AtomicLazyState& operator=(const AtomicLazyState& p_other)
+        {
+            store(p_other.load(std::memory_order_acquire),
+                  std::memory_order_release);
+            return *this;
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    //! \brief Compute the attributes given as callables and move them to the
+    //! attributes.
+    //-------------------------------------------------------------------------
+    void resolveLazyAttributes() const
+    {
+        LazyState expected = LazyState::Pending;
+        if (!m_lazy_state.compare_exchange_strong(
+                expected, LazyState::Resolving, std::memory_order_acquire))
+        {
+            // Resolved by another thread: wait for its values.
+            while (m_lazy_state.load(std::memory_order_acquire) !=
+                   LazyState::None)
+            {
+                std::this_thread::yield();
+            }
+            return;
+        }
+
+        MYLOGGER_ALLOCATION_SCOPE(Trace);
+        for (auto& [key, compute] : m_lazy_attributes)
+        {
+            m_attributes[key] = compute();
+        }
+        m_lazy_attributes.clear();
+        m_lazy_state.store(LazyState::None, std::memory_order_release);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Forget the pending callable of an attribute, replaced by a
+    //! newer value.
+    //-------------------------------------------------------------------------
+    void eraseLazyAttribute(const std::string& p_key)
+    {
+        for (auto it = m_lazy_attributes.begin(); it != m_lazy_attributes.end();
+             ++it)
+        {
+            if (it->first == p_key)
+            {
+                m_lazy_attributes.erase(it);
+                return;
+            }
+        }
+    }
+
     //! \brief The operation name
     std::string m_operation_name;
     //! \brief The trace ID (16 bytes = 32 hex chars)
@@ -326,19 +595,32 @@ private:
     //! \brief The span ID (8 bytes = 16 hex chars)
     std::string m_span_id;
     //! \brief The parent span ID (empty for root spans)
-    std::string m_parent_trace_id;
-    //! \brief Attributes key-value pairs
-    Attributes m_attributes;
+    std::string m_parent_span_id;
+    //! \brief Attributes key-value pairs (completed by resolveAttributes()
+    //! with the lazy attributes)
+    mutable Attributes m_attributes;
+    //! \brief Attributes computed when the trace is formatted, in insertion
+    //! order
+    mutable std::vector<std::pair<std::string, LazyAttribute>>
+        m_lazy_attributes;
+    //! \brief Whether lazy attributes are waiting for resolveAttributes()
+    mutable AtomicLazyState m_lazy_state;
     //! \brief Tags key-value pairs
     Tags m_tags;
-    //! \brief Child spans
-    std::vector<std::shared_ptr<Trace>> m_children;
+    //! \brief Child spans (appended concurrently)
+    SpanList m_children;
     //! \brief Events
     std::vector<Event> m_events;
+    //! \brief Exporter of the spans in streaming mode (shared by the spans)
+    std::shared_ptr<const SpanExporter> m_exporter;
     //! \brief Start time in nanoseconds since epoch
     uint64_t m_start_time_nanos;
     //! \brief End time in nanoseconds since epoch
     uint64_t m_end_time_nanos;
     //! \brief Whether the trace has ended
     bool m_ended = false;
+    //! \brief Whether the trace is recorded (sampling decision)
+    bool m_sampled = true;
+    //! \brief Whether the sampling decision has been taken
+    bool m_sampling_decided = false;
 };
\ No newline at end of file
@@ -1,12 +1,12 @@
 #pragma once
 
+#include "MyLogger/Strategies/AllocationTracker.hpp"
+#include "MyLogger/Strategies/LogTrace.hpp"
+#include "MyLogger/Strategies/LoggerMetrics.hpp"
+
 #include <mutex>
 #include <string>
 
-// Forward declarations
-class Trace;
-enum class LogLevel;
-
 // *****************************************************************************
 //! \brief Thread-safe template-based strategy pattern for writing logs.
 //! This uses CRTP (Curiously Recurring Template Pattern) to avoid virtual
@@ -36,15 +36,32 @@ public:
     //-------------------------------------------------------------------------
     void writeLine(LogLevel p_level, const Trace& p_trace)
     {
+        MYLOGGER_ALLOCATION_SCOPE(Writer);
+        const auto started = startTimer();
+        p_trace.resolveAttributes(true);
         std::string begin = m_line_formatter.formatBegin(p_level);
         std::string middle = m_line_formatter.formatMiddle(p_trace);
         std::string end = m_line_formatter.formatEnd();
 
         // Write each part under the same lock
-        std::lock_guard<std::mutex> lock(m_write_mutex);
-        static_cast<Derived*>(this)->writeImpl(begin);
-        static_cast<Derived*>(this)->writeImpl(middle);
-        static_cast<Derived*>(this)->writeImpl(end);
+        writeRecord(p_level, begin, middle, end, started);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write a single ended span (streaming mode).
+    //! \param p_level The log level.
+    //! \param p_span The span, written without its child spans.
+    //-------------------------------------------------------------------------
+    void writeSpan(LogLevel p_level, const Trace& p_span)
+    {
+        MYLOGGER_ALLOCATION_SCOPE(Writer);
+        const auto started = startTimer();
+        p_span.resolveAttributes(false);
+        std::string begin = m_line_formatter.formatBegin(p_level);
+        std::string middle = m_line_formatter.formatSpan(p_span);
+        std::string end = m_line_formatter.formatEnd();
+
+        writeRecord(p_level, begin, middle, end, started);
     }
 
     //-------------------------------------------------------------------------
@@ -54,13 +71,12 @@ public:
     //-------------------------------------------------------------------------
     void writeLine(LogLevel p_level, const std::string& p_message)
     {
+        MYLOGGER_ALLOCATION_SCOPE(Writer);
+        const auto started = startTimer();
         std::string begin = m_line_formatter.formatBegin(p_level);
         std::string end = m_line_formatter.formatEnd();
 
-        std::lock_guard<std::mutex> lock(m_write_mutex);
-        static_cast<Derived*>(this)->writeImpl(begin);
-        static_cast<Derived*>(this)->writeImpl(p_message);
-        static_cast<Derived*>(this)->writeImpl(end);
+        writeRecord(p_level, begin, p_message, end, started);
     }
 
     //-------------------------------------------------------------------------
@@ -70,6 +86,28 @@ public:
     {
         std::lock_guard<std::mutex> lock(m_write_mutex);
         static_cast<Derived*>(this)->flushImpl();
+        if (m_metrics != nullptr)
+        {
+            m_metrics->onFlush();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Set the metrics fed by the writer, or nullptr to stop feeding
+    //! them. Called by the Logger under its lock.
+    //-------------------------------------------------------------------------
+    void setMetrics(LoggerMetrics* p_metrics)
+    {
+        m_metrics = p_metrics;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the metrics fed by the writer (nullptr if disabled).
+    //! Derived writers report their drops and queue depths there.
+    //-------------------------------------------------------------------------
+    LoggerMetrics* getMetrics() const
+    {
+        return m_metrics;
     }
 
     //-------------------------------------------------------------------------
@@ -102,10 +140,87 @@ public:
         }
     }
 
+    //-------------------------------------------------------------------------
+    //! \brief Write the three parts of a record. Called under lock.
+    //! The default forwards each part to writeImpl(). Derived writers that
+    //! need to know where a record ends (batching, framing, compression)
+    //! shadow this method.
+    //! \param p_level The log level.
+    //! \param p_begin The formatted beginning of the record.
+    //! \param p_middle The formatted body of the record.
+    //! \param p_end The formatted end of the record.
+    //-------------------------------------------------------------------------
+    void writeRecordImpl(LogLevel /*p_level*/,
+                         const std::string& p_begin,
+                         const std::string& p_middle,
+                         const std::string& p_end)
+    {
+        static_cast<Derived*>(this)->writeImpl(p_begin);
+        static_cast<Derived*>(this)->writeImpl(p_middle);
+        static_cast<Derived*>(this)->writeImpl(p_end);
+    }
+
+protected:
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the start time of a record when metrics are enabled.
+    //-------------------------------------------------------------------------
+    LoggerMetrics::Clock::time_point startTimer() const
+    {
+        return (m_metrics != nullptr) ? LoggerMetrics::Clock::now()
+                                      : LoggerMetrics::Clock::time_point();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Report to the metrics the records dropped by a derived writer
+    //! since the last report. Called under lock.
+    //! \param p_total Records dropped by the writer since its creation.
+    //-------------------------------------------------------------------------
+    void reportDroppedRecords(uint64_t p_total)
+    {
+        if ((m_metrics != nullptr) && (p_total > m_reported_drops))
+        {
+            m_metrics->onDropped(p_total - m_reported_drops);
+            m_reported_drops = p_total;
+        }
+    }
+
 private:
 
+    //-------------------------------------------------------------------------
+    //! \brief Write a formatted record under lock and account for it when
+    //! metrics are enabled.
+    //! \param p_started Time the formatting started (see startTimer()).
+    //-------------------------------------------------------------------------
+    void writeRecord(LogLevel p_level,
+                     const std::string& p_begin,
+                     const std::string& p_middle,
+                     const std::string& p_end,
+                     LoggerMetrics::Clock::time_point p_started)
+    {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        if (m_metrics == nullptr)
+        {
+            static_cast<Derived*>(this)->writeRecordImpl(
+                p_level, p_begin, p_middle, p_end);
+            return;
+        }
+
+        const auto formatted = LoggerMetrics::Clock::now();
+        static_cast<Derived*>(this)->writeRecordImpl(
+            p_level, p_begin, p_middle, p_end);
+        m_metrics->onRecord(p_level,
+                            p_begin.size() + p_middle.size() + p_end.size(),
+                            formatted - p_started,
+                            LoggerMetrics::Clock::now() - formatted);
+    }
+
     //! \brief The derived line formatter.
     LineFormatterType& m_line_formatter;
     //! \brief Protects all write operations.
     mutable std::mutex m_write_mutex;
+    //! \brief Metrics fed by the writer (nullptr if disabled).
+    LoggerMetrics* m_metrics = nullptr;
+    //! \brief Drops of the derived writer already reported to the metrics.
+    uint64_t m_reported_drops = 0u;
 };
\ No newline at end of file
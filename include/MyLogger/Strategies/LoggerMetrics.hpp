@@ -0,0 +1,220 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLevel.hpp"
+#include "MyLogger/Strategies/LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// *****************************************************************************
+//! \brief Percentiles of a LatencyHistogram, in nanoseconds.
+// *****************************************************************************
+struct LatencySummary
+{
+    //! \brief Number of recorded durations
+    uint64_t count = 0u;
+    //! \brief Mean duration
+    double mean = 0.0;
+    //! \brief Median duration
+    uint64_t p50 = 0u;
+    //! \brief 99th percentile
+    uint64_t p99 = 0u;
+    //! \brief Longest duration
+    uint64_t max = 0u;
+
+    //-------------------------------------------------------------------------
+    //! \brief Summarize a histogram.
+    //-------------------------------------------------------------------------
+    static LatencySummary of(const LatencyHistogram& p_histogram)
+    {
+        LatencySummary summary;
+        summary.count = p_histogram.count();
+        summary.mean = p_histogram.mean();
+        summary.p50 = p_histogram.percentile(50.0);
+        summary.p99 = p_histogram.percentile(99.0);
+        summary.max = p_histogram.max();
+        return summary;
+    }
+};
+
+// *****************************************************************************
+//! \brief Copy of the counters of LoggerMetrics at a given time.
+// *****************************************************************************
+struct LoggerMetricsSnapshot
+{
+    //! \brief Number of levels (TRACE to FATAL).
+    static constexpr size_t LEVELS = 6u;
+
+    //! \brief Records written per level, indexed by levelIndex()
+    uint64_t records[LEVELS] = {};
+    //! \brief Bytes of the written records
+    uint64_t bytes = 0u;
+    //! \brief Records dropped by the writer (full queue or spool)
+    uint64_t dropped = 0u;
+    //! \brief Traces not logged because of sampling
+    uint64_t sampled_out = 0u;
+    //! \brief Traces suppressed by the rate limiter
+    uint64_t rate_limited = 0u;
+    //! \brief Largest number of records seen waiting in a writer queue
+    uint64_t queue_high_water = 0u;
+    //! \brief Number of flushes
+    uint64_t flushes = 0u;
+    //! \brief Time spent formatting the records
+    LatencySummary format_time;
+    //! \brief Time spent in the writer (write or enqueue) per record
+    LatencySummary write_time;
+
+    //-------------------------------------------------------------------------
+    //! \brief Index of a level in records[].
+    //-------------------------------------------------------------------------
+    static size_t levelIndex(LogLevel p_level)
+    {
+        const int severity = to_severity_number(p_level);
+        return (severity <= 1) ? 0u
+                               : std::min(LEVELS - 1u,
+                                          static_cast<size_t>(severity - 1) /
+                                              4u);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of records written at a level.
+    //-------------------------------------------------------------------------
+    uint64_t getRecords(LogLevel p_level) const
+    {
+        return records[levelIndex(p_level)];
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of records written at all levels.
+    //-------------------------------------------------------------------------
+    uint64_t getTotalRecords() const
+    {
+        uint64_t total = 0u;
+        for (uint64_t count : records)
+        {
+            total += count;
+        }
+        return total;
+    }
+};
+
+// *****************************************************************************
+//! \brief Self-instrumentation of the Logger: records per level, bytes,
+//! drops, queue high-water mark, flushes, and histograms of the formatting
+//! and writing times.
+//!
+//! Updated by the writer (see LogWriter::setMetrics()) with relaxed atomics
+//! only: updating never takes a lock and snapshot() can be called from any
+//! thread while logging. The Logger only feeds it once enabled (see
+//! Logger::enableMetrics()), so that disabled metrics cost a null pointer
+//! check per record.
+// *****************************************************************************
+class LoggerMetrics
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    //! \brief Operation name of the self-report traces.
+    static constexpr const char* REPORT_NAME = "mylogger.metrics";
+
+    //-------------------------------------------------------------------------
+    //! \brief Account for a written record.
+    //! \param p_level The level of the record.
+    //! \param p_bytes The size of the formatted record.
+    //! \param p_format_time Time spent formatting the record.
+    //! \param p_write_time Time spent writing (or queuing) the record.
+    //-------------------------------------------------------------------------
+    void onRecord(LogLevel p_level,
+                  size_t p_bytes,
+                  Clock::duration p_format_time,
+                  Clock::duration p_write_time)
+    {
+        m_records[LoggerMetricsSnapshot::levelIndex(p_level)].fetch_add(
+            1u, std::memory_order_relaxed);
+        m_bytes.fetch_add(p_bytes, std::memory_order_relaxed);
+        m_format_time.record(nanoseconds(p_format_time));
+        m_write_time.record(nanoseconds(p_write_time));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Account for records dropped by the writer.
+    //-------------------------------------------------------------------------
+    void onDropped(uint64_t p_records = 1u)
+    {
+        m_dropped.fetch_add(p_records, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Account for the depth of a writer queue after a push.
+    //-------------------------------------------------------------------------
+    void onQueueDepth(size_t p_depth)
+    {
+        uint64_t current = m_queue_high_water.load(std::memory_order_relaxed);
+        while ((p_depth > current) &&
+               !m_queue_high_water.compare_exchange_weak(
+                   current, p_depth, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Account for a flush.
+    //-------------------------------------------------------------------------
+    void onFlush()
+    {
+        m_flushes.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Copy the counters. The sampling and rate limiting counters are
+    //! kept by the Logger, which completes the snapshot.
+    //-------------------------------------------------------------------------
+    LoggerMetricsSnapshot snapshot() const
+    {
+        LoggerMetricsSnapshot snapshot;
+        for (size_t i = 0u; i < LoggerMetricsSnapshot::LEVELS; ++i)
+        {
+            snapshot.records[i] = m_records[i].load(std::memory_order_relaxed);
+        }
+        snapshot.bytes = m_bytes.load(std::memory_order_relaxed);
+        snapshot.dropped = m_dropped.load(std::memory_order_relaxed);
+        snapshot.queue_high_water =
+            m_queue_high_water.load(std::memory_order_relaxed);
+        snapshot.flushes = m_flushes.load(std::memory_order_relaxed);
+        snapshot.format_time = LatencySummary::of(m_format_time);
+        snapshot.write_time = LatencySummary::of(m_write_time);
+        return snapshot;
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Convert a duration into nanoseconds.
+    //-------------------------------------------------------------------------
+    static uint64_t nanoseconds(Clock::duration p_duration)
+    {
+        const auto count =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(p_duration)
+                .count();
+        return (count < 0) ? 0u : static_cast<uint64_t>(count);
+    }
+
+    //! \brief Records written per level
+    std::atomic<uint64_t> m_records[LoggerMetricsSnapshot::LEVELS] = {};
+    //! \brief Bytes of the written records
+    std::atomic<uint64_t> m_bytes{ 0u };
+    //! \brief Records dropped by the writer
+    std::atomic<uint64_t> m_dropped{ 0u };
+    //! \brief Largest writer queue depth
+    std::atomic<uint64_t> m_queue_high_water{ 0u };
+    //! \brief Number of flushes
+    std::atomic<uint64_t> m_flushes{ 0u };
+    //! \brief Formatting time per record, in nanoseconds
+    LatencyHistogram m_format_time;
+    //! \brief Writing time per record, in nanoseconds
+    LatencyHistogram m_write_time;
+};
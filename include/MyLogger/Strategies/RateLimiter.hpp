@@ -0,0 +1,218 @@
+#pragma once
+
+#include "MyLogger/Strategies/LogTrace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// *****************************************************************************
+//! \brief Tuning of the RateLimiter.
+// *****************************************************************************
+struct RateLimiterConfig
+{
+    //! \brief Traces per second allowed for each operation name. 0 disables
+    //! the rate limiter.
+    double rate = 0.0;
+    //! \brief Traces an operation can log in a burst after being idle.
+    double burst = 100.0;
+    //! \brief Period of the summary of suppressed traces.
+    std::chrono::milliseconds summary_interval{ 10000 };
+    //! \brief Number of distinct operation names tracked. Beyond, the
+    //! remaining names share a single bucket.
+    size_t max_operations = 1024u;
+};
+
+// *****************************************************************************
+//! \brief Token-bucket rate limiter keyed by the operation name of the traces.
+//!
+//! Each operation name gets its own bucket, refilled at the configured rate
+//! up to the burst size: a hot loop exhausts its own bucket only and cannot
+//! saturate the writer, while the other operations are unaffected. Each name
+//! is stored once in the table and later lookups do not allocate. Once the
+//! table is full, the other names share an overflow bucket kept out of the
+//! table.
+//!
+//! The suppressed traces are counted per operation and summarized
+//! periodically in a "rate_limiter.suppressed" trace (see summarize()).
+//! The attributes of the summary are prefixed by OPERATION_PREFIX, so that
+//! no operation name can collide with its "total" attribute.
+//! Not thread-safe: the Logger calls it under its lock.
+// *****************************************************************************
+class RateLimiter
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    //! \brief Operation name of the summary traces.
+    static constexpr const char* SUMMARY_NAME = "rate_limiter.suppressed";
+    //! \brief Name of the bucket shared by the operations beyond the limit.
+    static constexpr const char* OVERFLOW_KEY = "<other>";
+    //! \brief Prefix of the per-operation attributes of the summary traces.
+    static constexpr const char* OPERATION_PREFIX = "operation.";
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_config Rates and summary period. Disabled by default.
+    //-------------------------------------------------------------------------
+    explicit RateLimiter(const RateLimiterConfig& p_config = {})
+        : m_config(p_config),
+          m_overflow{ p_config.burst, Clock::now() }
+    {
+        m_next_summary = Clock::now() + m_config.summary_interval;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if traces are rate limited.
+    //-------------------------------------------------------------------------
+    bool isEnabled() const
+    {
+        return m_config.rate > 0.0;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Take a token from the bucket of an operation.
+    //! \param p_operation_name The operation name of the trace.
+    //! \param p_now The current time.
+    //! \return false if the trace shall be suppressed.
+    //-------------------------------------------------------------------------
+    bool tryAcquire(const std::string& p_operation_name,
+                    Clock::time_point p_now)
+    {
+        if (!isEnabled())
+        {
+            return true;
+        }
+
+        Bucket& bucket = getBucket(p_operation_name, p_now);
+        const std::chrono::duration<double> elapsed =
+            p_now - bucket.last_refill;
+        bucket.tokens = std::min(
+            m_config.burst, bucket.tokens + elapsed.count() * m_config.rate);
+        bucket.last_refill = p_now;
+
+        if (bucket.tokens < 1.0)
+        {
+            ++bucket.suppressed;
+            ++m_suppressed;
+            m_pending_summary = true;
+            return false;
+        }
+        bucket.tokens -= 1.0;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if a summary is due: traces have been suppressed since the
+    //! last summary and the summary period elapsed.
+    //-------------------------------------------------------------------------
+    bool isSummaryDue(Clock::time_point p_now) const
+    {
+        return m_pending_summary && (p_now >= m_next_summary);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Fill a summary trace with the number of traces suppressed per
+    //! operation since the last summary, then reset these numbers.
+    //! \param p_summary The trace receiving one "operation.<name>" attribute
+    //! per operation and a "total" attribute.
+    //! \param p_now The current time.
+    //! \return false if no trace has been suppressed since the last summary.
+    //-------------------------------------------------------------------------
+    bool summarize(Trace& p_summary, Clock::time_point p_now)
+    {
+        m_next_summary = p_now + m_config.summary_interval;
+        if (!m_pending_summary)
+        {
+            return false;
+        }
+
+        uint64_t total = 0u;
+        for (auto& [name, bucket] : m_buckets)
+        {
+            total += summarizeBucket(p_summary, name, bucket);
+        }
+        total += summarizeBucket(p_summary, OVERFLOW_KEY, m_overflow);
+        p_summary.addAttribute("total", std::to_string(total));
+        m_pending_summary = false;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of traces suppressed since the creation.
+    //-------------------------------------------------------------------------
+    uint64_t getSuppressedTraces() const
+    {
+        return m_suppressed;
+    }
+
+private:
+
+    //! \brief Token bucket of an operation.
+    struct Bucket
+    {
+        //! \brief Available tokens
+        double tokens;
+        //! \brief Time of the last refill
+        Clock::time_point last_refill;
+        //! \brief Traces suppressed since the last summary
+        uint64_t suppressed = 0u;
+    };
+
+    //-------------------------------------------------------------------------
+    //! \brief Find the bucket of an operation, creating it full if needed.
+    //! Beyond the size of the table, the overflow bucket is returned.
+    //-------------------------------------------------------------------------
+    Bucket& getBucket(const std::string& p_operation_name,
+                      Clock::time_point p_now)
+    {
+        auto it = m_buckets.find(p_operation_name);
+        if (it != m_buckets.end())
+        {
+            return it->second;
+        }
+
+        if (m_buckets.size() < m_config.max_operations)
+        {
+            return m_buckets
+                .try_emplace(p_operation_name, Bucket{ m_config.burst, p_now })
+                .first->second;
+        }
+        return m_overflow;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Add the suppressed traces of a bucket to a summary trace and
+    //! reset them.
+    //! \return The number of suppressed traces of the bucket.
+    //-------------------------------------------------------------------------
+    static uint64_t summarizeBucket(Trace& p_summary,
+                                    const std::string& p_operation_name,
+                                    Bucket& p_bucket)
+    {
+        const uint64_t suppressed = p_bucket.suppressed;
+        if (suppressed > 0u)
+        {
+            p_summary.addAttribute(OPERATION_PREFIX + p_operation_name,
+                                   std::to_string(suppressed));
+            p_bucket.suppressed = 0u;
+        }
+        return suppressed;
+    }
+
+    //! \brief Rates and summary period
+    RateLimiterConfig m_config;
+    //! \brief Buckets per operation name
+    std::unordered_map<std::string, Bucket> m_buckets;
+    //! \brief Bucket shared by the operations beyond max_operations
+    Bucket m_overflow;
+    //! \brief Time of the next summary
+    Clock::time_point m_next_summary;
+    //! \brief Traces have been suppressed since the last summary
+    bool m_pending_summary = false;
+    //! \brief Traces suppressed since the creation
+    uint64_t m_suppressed = 0u;
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "MyLogger/Strategies/AllocationTracker.hpp"
+#include "MyLogger/Strategies/LogTrace.hpp"
+#include "MyLogger/Strategies/TraceContext.hpp"
+
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+// *****************************************************************************
+//! \brief Span living for the duration of a C++ scope, for instrumenting
+//! functions without passing traces around nor calling Trace::end().
+//!
+//! A scoped span is created as a child of the span active on the calling
+//! thread (see TraceContext), is itself the active span until the scope is
+//! left, then ends. A request is entered by giving its root trace explicitly
+//! or by making it active with a TraceContext::Scope:
+//! \code
+//!   void handle(Trace& request)
+//!   {
+//!       ScopedSpan span(request, "handle");
+//!       parse(); // ScopedSpan span("parse") is a child of "handle"
+//!   }
+//! \endcode
+//!
+//! When no span is active or the active trace is not sampled (see
+//! HeadSampler), the scoped span records nothing: it neither allocates nor
+//! reads the clock, so that hot functions can stay instrumented. This is the
+//! only case without allocation. A recorded span is a Trace created by
+//! Trace::createChildSpan() and shared with its parent, which formats it
+//! after the scope is left. Its storage comes from the per-thread SpanPool,
+//! but its ID strings are still allocated: about 4 allocations (~400 bytes)
+//! per span (see BM_ScopedSpan).
+//!
+//! Operation names are C strings (i.e. literals) so that no std::string is
+//! built when nothing is recorded. Scoped spans shall be destroyed in the
+//! reverse order of their construction, on the thread that created them,
+//! which C++ scopes guarantee.
+// *****************************************************************************
+class ScopedSpan
+{
+public:
+
+    using AttributeList =
+        std::initializer_list<std::pair<const char*, const char*>>;
+
+    //-------------------------------------------------------------------------
+    //! \brief Start a span child of the span active on this thread.
+    //! \param p_operation_name The name of the operation.
+    //! \param p_attributes Key-value pairs for the span attributes.
+    //-------------------------------------------------------------------------
+    explicit ScopedSpan(const char* p_operation_name,
+                        AttributeList p_attributes = {})
+        : ScopedSpan(TraceContext::current(), p_operation_name, p_attributes)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Start a span child of the given trace (i.e. the root trace of a
+    //! request), whatever the span active on this thread.
+    //! \param p_parent The parent trace. It shall outlive the scoped span.
+    //! \param p_operation_name The name of the operation.
+    //! \param p_attributes Key-value pairs for the span attributes.
+    //-------------------------------------------------------------------------
+    ScopedSpan(Trace& p_parent,
+               const char* p_operation_name,
+               AttributeList p_attributes = {})
+        : ScopedSpan(&p_parent, p_operation_name, p_attributes)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief End the span and make active again the span it replaced.
+    //-------------------------------------------------------------------------
+    ~ScopedSpan()
+    {
+        end();
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    //-------------------------------------------------------------------------
+    //! \brief Add an attribute to the span, if recorded.
+    //-------------------------------------------------------------------------
+    template <typename Value>
+    void addAttribute(const std::string& p_key, Value&& p_value)
+    {
+        if (m_span != nullptr)
+        {
+            m_span->addAttribute(p_key, std::forward<Value>(p_value));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Add an event to the span, if recorded.
+    //-------------------------------------------------------------------------
+    void addEvent(const std::string& p_name, AttributeList p_attributes = {})
+    {
+        if (m_span != nullptr)
+        {
+            m_span->addEvent(p_name, p_attributes);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief End the span before the end of the scope. The span stays the
+    //! parent of the scoped spans created until the end of the scope.
+    //-------------------------------------------------------------------------
+    void end()
+    {
+        if (m_span != nullptr)
+        {
+            m_span->end();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the span is recorded (an active trace was sampled).
+    //-------------------------------------------------------------------------
+    inline bool isRecording() const
+    {
+        return m_span != nullptr;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the recorded span, or nullptr when nothing is recorded.
+    //-------------------------------------------------------------------------
+    inline Trace* getSpan() const
+    {
+        return m_span.get();
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Start a span child of p_parent if it is sampled, and make it
+    //! the active span. Otherwise p_parent becomes the active span so that
+    //! the nested scoped spans also skip recording.
+    //-------------------------------------------------------------------------
+    ScopedSpan(Trace* p_parent,
+               const char* p_operation_name,
+               AttributeList p_attributes)
+        : m_span(startSpan(p_parent, p_operation_name, p_attributes)),
+          m_scope((m_span != nullptr) ? m_span.get() : p_parent)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Create the span child of p_parent, or nullptr if p_parent is
+    //! not recorded.
+    //-------------------------------------------------------------------------
+    static std::shared_ptr<Trace> startSpan(Trace* p_parent,
+                                            const char* p_operation_name,
+                                            AttributeList p_attributes)
+    {
+        if ((p_parent == nullptr) || !p_parent->isSampled())
+        {
+            return nullptr;
+        }
+
+        MYLOGGER_ALLOCATION_SCOPE(Trace);
+        return p_parent->createChildSpan(p_operation_name, p_attributes);
+    }
+
+    //! \brief The recorded span (null when nothing is recorded)
+    std::shared_ptr<Trace> m_span;
+    //! \brief Makes the span active until the scoped span is destroyed
+    TraceContext::Scope m_scope;
+};
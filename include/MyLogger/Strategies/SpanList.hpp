@@ -0,0 +1,347 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+
+class Trace;
+
+// *****************************************************************************
+//! \brief Append-only list of the child spans of a Trace, to which several
+//! threads can append concurrently without lock.
+//!
+//! Spans are stored in a chain of blocks of doubling capacity. An append
+//! reserves its index with an atomic increment, creates the block holding
+//! that index if no other thread did (compare-and-swap, the loser frees its
+//! block), stores the span and then publishes its slot. Spans are never
+//! moved once stored, so that iterating needs no lock either: it visits the
+//! published spans in the order their indices were reserved and skips the
+//! slots still being filled. Since formatters read a trace once its spans
+//! ended, they see all of them.
+// *****************************************************************************
+class SpanList
+{
+private:
+
+    //! \brief Capacity of the first block.
+    static constexpr size_t FIRST_BLOCK = 8u;
+
+    //! \brief Storage of a span.
+    struct Slot
+    {
+        //! \brief The span
+        std::shared_ptr<Trace> span;
+        //! \brief Whether span has been stored
+        std::atomic<bool> published{ false };
+    };
+
+    //! \brief Block of slots, linked to the next (twice larger) block.
+    struct Block
+    {
+        explicit Block(size_t p_capacity)
+            : slots(new Slot[p_capacity]), capacity(p_capacity)
+        {
+        }
+
+        //! \brief The slots
+        std::unique_ptr<Slot[]> slots;
+        //! \brief Number of slots
+        size_t capacity;
+        //! \brief Next block, created on demand
+        std::atomic<Block*> next{ nullptr };
+    };
+
+public:
+
+    // *************************************************************************
+    //! \brief Forward iterator on the published spans.
+    // *************************************************************************
+    class const_iterator
+    {
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::shared_ptr<Trace>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::shared_ptr<Trace>*;
+        using reference = const std::shared_ptr<Trace>&;
+
+        const_iterator() = default;
+
+        reference operator*() const
+        {
+            return m_block->slots[m_offset].span;
+        }
+
+        pointer operator->() const
+        {
+            return &m_block->slots[m_offset].span;
+        }
+
+        const_iterator& operator++()
+        {
+            advance();
+            skipUnpublished();
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        bool operator==(const const_iterator& p_other) const
+        {
+            return (m_block == p_other.m_block) &&
+                   (m_offset == p_other.m_offset);
+        }
+
+        bool operator!=(const const_iterator& p_other) const
+        {
+            return !(*this == p_other);
+        }
+
+    private:
+
+        friend class SpanList;
+
+        //---------------------------------------------------------------------
+        //! \brief Iterate over the p_remaining first slots from p_block.
+        //---------------------------------------------------------------------
+        const_iterator(const Block* p_block, size_t p_remaining)
+            : m_block(p_block), m_remaining(p_remaining)
+        {
+            if (m_remaining == 0u)
+            {
+                m_block = nullptr;
+            }
+            skipUnpublished();
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Move to the next slot, or to the end.
+        //---------------------------------------------------------------------
+        void advance()
+        {
+            if (--m_remaining == 0u)
+            {
+                m_block = nullptr;
+                m_offset = 0u;
+            }
+            else if (++m_offset == m_block->capacity)
+            {
+                m_block = m_block->next.load(std::memory_order_acquire);
+                m_offset = 0u;
+            }
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Move to the first published slot from the current one. The
+        //! end is reached at a block not created yet.
+        //---------------------------------------------------------------------
+        void skipUnpublished()
+        {
+            while ((m_block != nullptr) &&
+                   !m_block->slots[m_offset].published.load(
+                       std::memory_order_acquire))
+            {
+                advance();
+            }
+            if (m_block == nullptr)
+            {
+                m_offset = 0u;
+            }
+        }
+
+        //! \brief Current block (nullptr at the end)
+        const Block* m_block = nullptr;
+        //! \brief Current slot in the block
+        size_t m_offset = 0u;
+        //! \brief Slots left to visit, current one included
+        size_t m_remaining = 0u;
+    };
+
+    SpanList() = default;
+
+    //-------------------------------------------------------------------------
+    //! \brief Copy the published spans (the spans are shared, not cloned).
+    //-------------------------------------------------------------------------
+    SpanList(const SpanList& p_other)
+    {
+        for (const auto& span : p_other)
+        {
+            append(span);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Take the spans of another list, which shall not be appended to
+    //! concurrently.
+    //-------------------------------------------------------------------------
+    SpanList(SpanList&& p_other) noexcept
+        : m_head(p_other.m_head.exchange(nullptr)),
+          m_reserved(p_other.m_reserved.exchange(0u)),
+          m_size(p_other.m_size.exchange(0u))
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Replace the spans by the published spans of another list. Not
+    //! thread-safe.
+    //-------------------------------------------------------------------------
+    SpanList& operator=(const SpanList& p_other)
+    {
+        if (this != &p_other)
+        {
+            SpanList copy(p_other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Replace the spans by those of another list. Not thread-safe.
+    //-------------------------------------------------------------------------
+    SpanList& operator=(SpanList&& p_other) noexcept
+    {
+        if (this != &p_other)
+        {
+            SpanList taken(std::move(p_other));
+            swap(taken);
+        }
+        return *this;
+    }
+
+    ~SpanList()
+    {
+        Block* block = m_head.load(std::memory_order_relaxed);
+        while (block != nullptr)
+        {
+            Block* next = block->next.load(std::memory_order_relaxed);
+            delete block;
+            block = next;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a span. Thread-safe, lock-free.
+    //-------------------------------------------------------------------------
+    void append(std::shared_ptr<Trace> p_span)
+    {
+        size_t offset;
+        const size_t index =
+            m_reserved.fetch_add(1u, std::memory_order_relaxed);
+        Block* block = reserveBlock(index, offset);
+
+        Slot& slot = block->slots[offset];
+        slot.span = std::move(p_span);
+        slot.published.store(true, std::memory_order_release);
+        m_size.fetch_add(1u, std::memory_order_release);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of published spans.
+    //-------------------------------------------------------------------------
+    size_t size() const
+    {
+        return m_size.load(std::memory_order_acquire);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if no span has been published.
+    //-------------------------------------------------------------------------
+    bool empty() const
+    {
+        return size() == 0u;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Iterator on the first published span.
+    //-------------------------------------------------------------------------
+    const_iterator begin() const
+    {
+        return const_iterator(m_head.load(std::memory_order_acquire),
+                              m_reserved.load(std::memory_order_acquire));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Iterator past the last published span.
+    //-------------------------------------------------------------------------
+    const_iterator end() const
+    {
+        return const_iterator();
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the block holding a slot index, creating the missing
+    //! blocks up to it.
+    //! \param p_index The slot index.
+    //! \param p_offset [out] The index of the slot in the block.
+    //-------------------------------------------------------------------------
+    Block* reserveBlock(size_t p_index, size_t& p_offset)
+    {
+        std::atomic<Block*>* link = &m_head;
+        size_t first = 0u;
+        size_t capacity = FIRST_BLOCK;
+        while (true)
+        {
+            Block* block = link->load(std::memory_order_acquire);
+            if (block == nullptr)
+            {
+                block = createBlock(*link, capacity);
+            }
+            if (p_index < first + capacity)
+            {
+                p_offset = p_index - first;
+                return block;
+            }
+            first += capacity;
+            capacity *= 2u;
+            link = &block->next;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Create the block a link points to, unless another thread did.
+    //! \return The block linked.
+    //-------------------------------------------------------------------------
+    static Block* createBlock(std::atomic<Block*>& p_link, size_t p_capacity)
+    {
+        Block* created = new Block(p_capacity);
+        Block* expected = nullptr;
+        if (p_link.compare_exchange_strong(expected,
+                                           created,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_acquire))
+        {
+            return created;
+        }
+        delete created;
+        return expected;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Exchange the spans of two lists. Not thread-safe.
+    //-------------------------------------------------------------------------
+    void swap(SpanList& p_other) noexcept
+    {
+        m_head.store(p_other.m_head.exchange(
+            m_head.load(std::memory_order_relaxed)));
+        m_reserved.store(p_other.m_reserved.exchange(
+            m_reserved.load(std::memory_order_relaxed)));
+        m_size.store(
+            p_other.m_size.exchange(m_size.load(std::memory_order_relaxed)));
+    }
+
+    //! \brief First block (nullptr until the first append)
+    std::atomic<Block*> m_head{ nullptr };
+    //! \brief Number of reserved slots
+    std::atomic<size_t> m_reserved{ 0u };
+    //! \brief Number of published spans
+    std::atomic<size_t> m_size{ 0u };
+};
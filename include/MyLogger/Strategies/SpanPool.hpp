@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// *****************************************************************************
+//! \brief Per-thread cache of fixed-size memory blocks, recycling the storage
+//! of the child spans (see SpanAllocator).
+//!
+//! A freed block is kept by the freeing thread, up to CAPACITY blocks, and
+//! handed out again by its next allocation: once the cache of a thread is
+//! warm, creating and destroying spans does not call operator new. Blocks
+//! are plain operator new blocks of the same size, so that a span created by
+//! a thread and freed by another (i.e. a request handed to a worker) is just
+//! cached by the second one. The cache of a thread is released when the
+//! thread exits; blocks used afterwards by the exiting thread come from and
+//! go back to operator new and delete.
+//! \tparam Size The size of the blocks.
+// *****************************************************************************
+template <size_t Size>
+class SpanPool
+{
+public:
+
+    //! \brief Maximum number of free blocks kept by a thread.
+    static constexpr size_t CAPACITY = 256u;
+
+    //-------------------------------------------------------------------------
+    //! \brief Get a block, from the cache of the calling thread if possible.
+    //-------------------------------------------------------------------------
+    static void* allocate()
+    {
+        if (s_released || (s_cache.head == nullptr))
+        {
+            return ::operator new(Size);
+        }
+
+        Cache& cache = s_cache;
+        FreeBlock* block = cache.head;
+        cache.head = block->next;
+        --cache.count;
+        return block;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Give a block back to the cache of the calling thread, or to
+    //! operator delete if the cache is full or released.
+    //-------------------------------------------------------------------------
+    static void deallocate(void* p_block) noexcept
+    {
+        if (s_released || (s_cache.count >= CAPACITY))
+        {
+            ::operator delete(p_block);
+            return;
+        }
+
+        Cache& cache = s_cache;
+        cache.head = new (p_block) FreeBlock{ cache.head };
+        ++cache.count;
+    }
+
+private:
+
+    //! \brief Free block, linked to the next one.
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    static_assert(Size >= sizeof(FreeBlock), "Blocks too small");
+
+    // *************************************************************************
+    //! \brief Free blocks of a thread.
+    // *************************************************************************
+    struct Cache
+    {
+        ~Cache()
+        {
+            s_released = true;
+            while (head != nullptr)
+            {
+                FreeBlock* block = head;
+                head = block->next;
+                ::operator delete(block);
+            }
+        }
+
+        //! \brief First free block
+        FreeBlock* head = nullptr;
+        //! \brief Number of free blocks
+        size_t count = 0u;
+    };
+
+    //! \brief Free blocks of the calling thread
+    static thread_local Cache s_cache;
+    //! \brief The cache of the calling thread has been destroyed (trivially
+    //! destructible, so still readable while the thread exits)
+    static thread_local bool s_released;
+};
+
+template <size_t Size>
+thread_local typename SpanPool<Size>::Cache SpanPool<Size>::s_cache;
+
+template <size_t Size>
+thread_local bool SpanPool<Size>::s_released = false;
+
+// *****************************************************************************
+//! \brief Allocator of single objects from SpanPool, given to
+//! std::allocate_shared() so that the span and its reference counts share a
+//! recycled block. Arrays go to operator new.
+//! \tparam T The type of the allocated objects.
+// *****************************************************************************
+template <typename T>
+class SpanAllocator
+{
+public:
+
+    using value_type = T;
+
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "Over-aligned types are not supported");
+
+    SpanAllocator() = default;
+
+    template <typename U>
+    SpanAllocator(const SpanAllocator<U>& /*p_other*/) noexcept
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Allocate the storage of p_count objects.
+    //-------------------------------------------------------------------------
+    T* allocate(size_t p_count)
+    {
+        if (p_count != 1u)
+        {
+            return static_cast<T*>(::operator new(p_count * sizeof(T)));
+        }
+        return static_cast<T*>(SpanPool<sizeof(T)>::allocate());
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Release the storage of p_count objects.
+    //-------------------------------------------------------------------------
+    void deallocate(T* p_objects, size_t p_count) noexcept
+    {
+        if (p_count != 1u)
+        {
+            ::operator delete(p_objects);
+            return;
+        }
+        SpanPool<sizeof(T)>::deallocate(p_objects);
+    }
+
+    template <typename U>
+    bool operator==(const SpanAllocator<U>& /*p_other*/) const noexcept
+    {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const SpanAllocator<U>& /*p_other*/) const noexcept
+    {
+        return false;
+    }
+};
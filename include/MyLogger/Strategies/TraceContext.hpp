@@ -0,0 +1,160 @@
+#pragma once
+
+#include "MyLogger/Strategies/LogTrace.hpp"
+
+#include <utility>
+
+// *****************************************************************************
+//! \brief Span active on the calling thread, so that traces do not have to be
+//! passed through every layer of the code.
+//!
+//! The active span is a thread-local pointer. A Scope makes a span active
+//! until it is left and then restores the span it replaced: the stack of
+//! active spans lives in the scopes themselves, so that pushing and popping
+//! are pointer swaps, without lock nor allocation. ScopedSpan uses it to
+//! parent new spans automatically.
+//! \code
+//!   void handle(Trace& request)
+//!   {
+//!       TraceContext::Scope scope(request);
+//!       parse(); // ScopedSpan span("parse") is a child of request
+//!   }
+//! \endcode
+//!
+//! A task handed to a thread pool does not inherit the active span of the
+//! thread submitting it. capture() takes it and a Scope restores it on the
+//! worker thread, or wrap() does both around a callable:
+//! \code
+//!   pool.submit(TraceContext::wrap([] { ScopedSpan span("work"); }));
+//! \endcode
+//! The context only refers to the span: the span shall outlive the tasks
+//! using it. Tasks running in parallel can create child spans of the same
+//! span (see Trace::createChildSpan()).
+// *****************************************************************************
+class TraceContext
+{
+public:
+
+    // *************************************************************************
+    //! \brief Active span captured on a thread, to be restored on another.
+    // *************************************************************************
+    class Snapshot
+    {
+    public:
+
+        //---------------------------------------------------------------------
+        //! \brief Get the captured span, or nullptr if none was active.
+        //---------------------------------------------------------------------
+        inline Trace* getSpan() const
+        {
+            return m_span;
+        }
+
+    private:
+
+        friend class TraceContext;
+
+        explicit Snapshot(Trace* p_span) : m_span(p_span)
+        {
+        }
+
+        //! \brief The captured span
+        Trace* m_span;
+    };
+
+    // *************************************************************************
+    //! \brief Make a span the active span of the calling thread until the
+    //! scope is left. Scopes shall be left in the reverse order they were
+    //! entered, which C++ scopes guarantee.
+    // *************************************************************************
+    class Scope
+    {
+    public:
+
+        //---------------------------------------------------------------------
+        //! \brief Make p_span active. nullptr deactivates any span.
+        //---------------------------------------------------------------------
+        explicit Scope(Trace* p_span) : m_previous(s_current)
+        {
+            s_current = p_span;
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Make p_span active.
+        //---------------------------------------------------------------------
+        explicit Scope(Trace& p_span) : Scope(&p_span)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Restore a span captured on another thread.
+        //---------------------------------------------------------------------
+        explicit Scope(const Snapshot& p_snapshot) : Scope(p_snapshot.m_span)
+        {
+        }
+
+        ~Scope()
+        {
+            s_current = m_previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+
+        //! \brief Span active before this scope
+        Trace* m_previous;
+    };
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the span active on the calling thread, or nullptr.
+    //-------------------------------------------------------------------------
+    static Trace* current()
+    {
+        return s_current;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Make a span active without scope and return the span it
+    //! replaced. For the code whose activations do not nest with C++ scopes
+    //! (i.e. CoroutineSpan across suspensions); prefer Scope otherwise.
+    //-------------------------------------------------------------------------
+    static Trace* exchange(Trace* p_span)
+    {
+        Trace* previous = s_current;
+        s_current = p_span;
+        return previous;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Capture the span active on the calling thread.
+    //-------------------------------------------------------------------------
+    static Snapshot capture()
+    {
+        return Snapshot(s_current);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Wrap a callable so that it runs with the span active on the
+    //! calling thread, whatever the thread running it.
+    //! \param p_task The callable (i.e. a task for a thread pool).
+    //! \return A callable taking the same arguments as p_task.
+    //-------------------------------------------------------------------------
+    template <typename Task>
+    static auto wrap(Task&& p_task)
+    {
+        return [snapshot = capture(),
+                task = std::forward<Task>(p_task)](auto&&... p_args) mutable
+                   -> decltype(auto)
+        {
+            Scope scope(snapshot);
+            return task(std::forward<decltype(p_args)>(p_args)...);
+        };
+    }
+
+private:
+
+    //! \brief Span active on the thread
+    static inline thread_local Trace* s_current = nullptr;
+};
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLevel.hpp"
+#include "MyLogger/Strategies/LogTrace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// *****************************************************************************
+//! \brief Head-based probabilistic sampling.
+//! The decision is taken from the low 64 bits of the trace ID: it is
+//! deterministic for a given trace ID, so that every service seeing the same
+//! trace takes the same decision. It is best taken once, when the root trace
+//! is created (see sample()), so that child spans inherit it without any
+//! further cost. Otherwise it is taken when the trace is logged (see
+//! isSampled()), giving the same result.
+//!
+//! The ratio is held in atomics: deciding never locks and the ratio can be
+//! changed while other threads sample (they use the old or the new ratio).
+// *****************************************************************************
+class HeadSampler
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_ratio Proportion of traces kept, in [0, 1]. 1 keeps them all.
+    //-------------------------------------------------------------------------
+    explicit HeadSampler(double p_ratio = 1.0)
+    {
+        setRatio(p_ratio);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Copy constructor.
+    //-------------------------------------------------------------------------
+    HeadSampler(const HeadSampler& p_other)
+    {
+        *this = p_other;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Copy the ratio of another sampler. Thread-safe.
+    //-------------------------------------------------------------------------
+    HeadSampler& operator=(const HeadSampler& p_other)
+    {
+        m_ratio.store(p_other.m_ratio.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+        m_threshold.store(p_other.m_threshold.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+        return *this;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Set the proportion of traces kept. Thread-safe.
+    //! \param p_ratio Proportion of traces kept, in [0, 1].
+    //-------------------------------------------------------------------------
+    void setRatio(double p_ratio)
+    {
+        m_ratio.store(p_ratio, std::memory_order_relaxed);
+        m_threshold.store(threshold(p_ratio), std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the proportion of traces kept.
+    //-------------------------------------------------------------------------
+    double getRatio() const
+    {
+        return m_ratio.load(std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Decide whether a trace ID is sampled. Thread-safe, lock-free.
+    //! \param p_trace_id The trace ID (hexadecimal string).
+    //-------------------------------------------------------------------------
+    bool shouldSample(const std::string& p_trace_id) const
+    {
+        const uint64_t threshold = m_threshold.load(std::memory_order_relaxed);
+        return (threshold == KEEP_ALL) || (lowBits(p_trace_id) < threshold);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Decide and store the sampling decision of a root trace.
+    //! \param p_trace The root trace, before creating its child spans.
+    //! \return true if the trace is sampled.
+    //-------------------------------------------------------------------------
+    bool sample(Trace& p_trace) const
+    {
+        const bool sampled = shouldSample(p_trace.getTraceId());
+        p_trace.setSampled(sampled);
+        return sampled;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the sampling decision of a trace or span: the decision
+    //! stored on it if any, else the decision for its trace ID (the one its
+    //! root would have got from sample()). Thread-safe, lock-free.
+    //-------------------------------------------------------------------------
+    bool isSampled(const Trace& p_trace) const
+    {
+        return p_trace.isSamplingDecided()
+                   ? p_trace.isSampled()
+                   : shouldSample(p_trace.getTraceId());
+    }
+
+private:
+
+    //! \brief Threshold keeping every trace ID.
+    static constexpr uint64_t KEEP_ALL = UINT64_MAX;
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the threshold of the trace IDs kept for a ratio.
+    //-------------------------------------------------------------------------
+    static uint64_t threshold(double p_ratio)
+    {
+        if (p_ratio >= 1.0)
+        {
+            return KEEP_ALL;
+        }
+        if (p_ratio <= 0.0)
+        {
+            return 0u;
+        }
+        const double scaled = p_ratio * 18446744073709551616.0 /* 2^64 */;
+        return (scaled >= 18446744073709551616.0)
+                   ? KEEP_ALL - 1u
+                   : static_cast<uint64_t>(scaled);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Parse the last 16 hexadecimal digits of a trace ID.
+    //-------------------------------------------------------------------------
+    static uint64_t lowBits(const std::string& p_trace_id)
+    {
+        uint64_t value = 0u;
+        const size_t start =
+            (p_trace_id.size() > 16u) ? (p_trace_id.size() - 16u) : 0u;
+        for (size_t i = start; i < p_trace_id.size(); ++i)
+        {
+            const char c = p_trace_id[i];
+            uint64_t digit;
+            if ((c >= '0') && (c <= '9'))
+            {
+                digit = uint64_t(c - '0');
+            }
+            else if ((c >= 'a') && (c <= 'f'))
+            {
+                digit = uint64_t(c - 'a' + 10);
+            }
+            else if ((c >= 'A') && (c <= 'F'))
+            {
+                digit = uint64_t(c - 'A' + 10);
+            }
+            else
+            {
+                digit = 0u;
+            }
+            value = (value << 4) | digit;
+        }
+        return value;
+    }
+
+    //! \brief Proportion of traces kept
+    std::atomic<double> m_ratio{ 1.0 };
+    //! \brief Trace IDs whose low bits are below this value are kept (all of
+    //! them if KEEP_ALL)
+    std::atomic<uint64_t> m_threshold{ KEEP_ALL };
+};
+
+// *****************************************************************************
+//! \brief Tail-based sampling.
+//! The decision is taken when the trace is logged, once its level and
+//! duration are known: traces logged with an error level or lasting longer
+//! than a threshold are kept, the others are dropped. Disabled by default.
+// *****************************************************************************
+class TailSampler
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor. Keeps every trace.
+    //-------------------------------------------------------------------------
+    TailSampler() = default;
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_min_level Traces logged with this level or above are kept.
+    //! \param p_min_duration Traces lasting at least this duration are kept.
+    //-------------------------------------------------------------------------
+    TailSampler(LogLevel p_min_level, std::chrono::nanoseconds p_min_duration)
+        : m_enabled(true),
+          m_min_level(p_min_level),
+          m_min_duration(p_min_duration)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the sampler filters traces.
+    //-------------------------------------------------------------------------
+    bool isEnabled() const
+    {
+        return m_enabled;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Decide whether a finished trace is kept.
+    //! \param p_level The level the trace is logged with.
+    //! \param p_trace The trace.
+    //-------------------------------------------------------------------------
+    bool shouldKeep(LogLevel p_level, const Trace& p_trace) const
+    {
+        if (!m_enabled)
+        {
+            return true;
+        }
+        if (static_cast<uint8_t>(p_level) >= static_cast<uint8_t>(m_min_level))
+        {
+            return true;
+        }
+        return p_trace.getDurationNanos() >=
+               static_cast<uint64_t>(m_min_duration.count());
+    }
+
+private:
+
+    //! \brief Whether traces are filtered
+    bool m_enabled = false;
+    //! \brief Traces logged with this level or above are kept
+    LogLevel m_min_level = LogLevel::ERROR;
+    //! \brief Traces lasting at least this duration are kept
+    std::chrono::nanoseconds m_min_duration{ 0 };
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLevel.hpp"
+#include "MyLogger/Strategies/LogWriter.hpp"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+
+// *****************************************************************************
+//! \brief Template-based console writer batching records on stdout.
+//!
+//! Unlike ConsoleLogWriter, which flushes std::cout for every part of every
+//! record, records are accumulated in a buffer and written to STDOUT_FILENO
+//! with a single write(2) once the buffer is full. This keeps the number of
+//! syscalls low when stdout is a pipe or a file (i.e. a container log
+//! collector).
+//!
+//! The buffer is written immediately when stdout is a terminal, so that an
+//! interactive user sees records as they come, and for records whose level
+//! is at least the flush level, so that errors are never held back.
+//!
+//! The writer bypasses std::cout: output written by the application through
+//! std::cout may not interleave with the records in program order.
+//! \tparam LineFormatterType The type of the line formatter.
+// *****************************************************************************
+template <typename LineFormatterType>
+class BufferedConsoleLogWriter
+    : public LogWriter<BufferedConsoleLogWriter<LineFormatterType>,
+                       LineFormatterType>
+{
+public:
+
+    //! \brief Default size of the buffer triggering a write.
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64u * 1024u;
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_line_formatter Reference to the line formatter.
+    //! \param p_flush_level Records of this level or above are written
+    //! immediately.
+    //! \param p_buffer_size Buffered bytes triggering a write.
+    //-------------------------------------------------------------------------
+    explicit BufferedConsoleLogWriter(
+        LineFormatterType& p_line_formatter,
+        LogLevel p_flush_level = LogLevel::ERROR,
+        size_t p_buffer_size = DEFAULT_BUFFER_SIZE)
+        : LogWriter<BufferedConsoleLogWriter<LineFormatterType>,
+                    LineFormatterType>(p_line_formatter),
+          m_flush_level(p_flush_level),
+          m_buffer_size(p_buffer_size),
+          m_is_tty(::isatty(STDOUT_FILENO) == 1)
+    {
+        m_buffer.reserve(m_buffer_size + m_buffer_size / 4u);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Destructor. Writes the buffered records.
+    //-------------------------------------------------------------------------
+    ~BufferedConsoleLogWriter()
+    {
+        writeBuffer();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Buffer a message (header, footer).
+    //! Called under lock by base class.
+    //! \param p_message The message to write.
+    //-------------------------------------------------------------------------
+    void writeImpl(const std::string& p_message)
+    {
+        m_buffer.append(p_message);
+        if (m_is_tty || (m_buffer.size() >= m_buffer_size))
+        {
+            writeBuffer();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Buffer a record and write the buffer when it is full, when
+    //! stdout is a terminal or when the level requires it.
+    //! Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void writeRecordImpl(LogLevel p_level,
+                         const std::string& p_begin,
+                         const std::string& p_middle,
+                         const std::string& p_end)
+    {
+        m_buffer.append(p_begin).append(p_middle).append(p_end);
+        if (m_is_tty || (m_buffer.size() >= m_buffer_size) ||
+            (static_cast<uint8_t>(p_level) >=
+             static_cast<uint8_t>(m_flush_level)))
+        {
+            writeBuffer();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the buffered records.
+    //! Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void flushImpl()
+    {
+        writeBuffer();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of write(2) calls made so far.
+    //-------------------------------------------------------------------------
+    uint64_t getWriteCount() const
+    {
+        return m_write_count;
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the whole buffer to stdout, resuming partial writes.
+    //! Records are discarded if stdout is closed or broken.
+    //-------------------------------------------------------------------------
+    void writeBuffer()
+    {
+        size_t offset = 0u;
+        while (offset < m_buffer.size())
+        {
+            ssize_t written = ::write(STDOUT_FILENO,
+                                      m_buffer.data() + offset,
+                                      m_buffer.size() - offset);
+            ++m_write_count;
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            offset += static_cast<size_t>(written);
+        }
+        m_buffer.clear();
+    }
+
+    //! \brief Records of this level or above are written immediately
+    LogLevel m_flush_level;
+    //! \brief Buffered bytes triggering a write
+    size_t m_buffer_size;
+    //! \brief Whether stdout is a terminal
+    bool m_is_tty;
+    //! \brief Pending records
+    std::string m_buffer;
+    //! \brief Statistics: number of write(2) calls
+    uint64_t m_write_count = 0u;
+};
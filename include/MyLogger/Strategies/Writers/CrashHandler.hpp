@@ -0,0 +1,227 @@
+#pragma once
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+
+// *****************************************************************************
+//! \brief Emergency flush of the log buffers on fatal signals.
+//!
+//! Writers keeping formatted records in memory (i.e. FileLogWriter) register
+//! a Region: a file descriptor, a buffer holding complete records only and a
+//! pre-formatted footer closing the file structure. Once install() has been
+//! called, a fatal signal writes the pending bytes and the footer of every
+//! region with write(2), then hands the signal over to the previous handler
+//! (by default: terminate the process).
+//!
+//! The handler is async-signal-safe: it takes no mutex (the Logger may hold
+//! its own when the signal arrives), does not allocate and only reads
+//! lock-free atomics. Records still being formatted or queued elsewhere are
+//! lost.
+// *****************************************************************************
+class CrashHandler
+{
+public:
+
+    //! \brief Maximum number of regions registered at the same time.
+    static constexpr size_t MAX_REGIONS = 16u;
+
+    // *********************************************************************
+    //! \brief Memory drained by the signal handler. Owned by a writer which
+    //! appends complete records after its size, publishes them by storing
+    //! the new size, and writes them out between tryLock() and unlock().
+    // *********************************************************************
+    struct Region
+    {
+        //! \brief Destination of the pending bytes
+        int fd = -1;
+        //! \brief Buffer of complete records (not reallocated once
+        //! registered)
+        const char* data = nullptr;
+        //! \brief Number of bytes of data to write
+        std::atomic<size_t> size{ 0u };
+        //! \brief Set while the buffer is written out (by the writer or by
+        //! the signal handler)
+        std::atomic<bool> busy{ false };
+        //! \brief Footer written after the pending bytes (set before
+        //! has_footer)
+        std::string footer;
+        //! \brief Whether the footer still has to be written
+        std::atomic<bool> has_footer{ false };
+
+        //---------------------------------------------------------------------
+        //! \brief Take the exclusive right to write the buffer out.
+        //! \return false if the buffer is already being written out.
+        //---------------------------------------------------------------------
+        bool tryLock()
+        {
+            return !busy.exchange(true, std::memory_order_acquire);
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Release the right taken by tryLock().
+        //---------------------------------------------------------------------
+        void unlock()
+        {
+            busy.store(false, std::memory_order_release);
+        }
+    };
+
+    static_assert(std::atomic<size_t>::is_always_lock_free &&
+                      std::atomic<bool>::is_always_lock_free,
+                  "The signal handler needs lock-free atomics");
+
+    //-------------------------------------------------------------------------
+    //! \brief Install the handler for the given signals. Also sets up an
+    //! alternate stack for the calling thread so that a stack overflow can
+    //! still be handled there. Idempotent: the signals already handled are
+    //! skipped, so that the handler never saves itself as the previous one.
+    //! \return false if a handler could not be installed.
+    //-------------------------------------------------------------------------
+    static bool install(std::initializer_list<int> p_signals = { SIGSEGV,
+                                                                 SIGABRT,
+                                                                 SIGTERM })
+    {
+        static char alternate_stack[64u * 1024u];
+        stack_t stack{};
+        stack.ss_sp = alternate_stack;
+        stack.ss_size = sizeof(alternate_stack);
+        ::sigaltstack(&stack, nullptr);
+
+        struct sigaction action{};
+        action.sa_handler = &CrashHandler::onSignal;
+        action.sa_flags = SA_ONSTACK;
+        sigfillset(&action.sa_mask);
+
+        bool installed = true;
+        for (int signal : p_signals)
+        {
+            if ((signal <= 0) || (signal >= NSIG))
+            {
+                installed = false;
+            }
+            else if (!s_installed[signal].exchange(true) &&
+                     (::sigaction(signal, &action, &s_previous[signal]) != 0))
+            {
+                s_installed[signal] = false;
+                installed = false;
+            }
+        }
+        return installed;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Register a region drained on fatal signals.
+    //! \return false if MAX_REGIONS regions are already registered.
+    //-------------------------------------------------------------------------
+    static bool registerRegion(Region& p_region)
+    {
+        for (auto& slot : s_regions)
+        {
+            Region* expected = nullptr;
+            if (slot.compare_exchange_strong(expected, &p_region))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Unregister a region before it is destroyed.
+    //-------------------------------------------------------------------------
+    static void unregisterRegion(Region& p_region)
+    {
+        for (auto& slot : s_regions)
+        {
+            Region* expected = &p_region;
+            slot.compare_exchange_strong(expected, nullptr);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the pending bytes and the footer of all regions.
+    //! Async-signal-safe. Called by the signal handler.
+    //-------------------------------------------------------------------------
+    static void drain()
+    {
+        for (auto& slot : s_regions)
+        {
+            Region* region = slot.load(std::memory_order_acquire);
+            if ((region == nullptr) || (region->fd < 0))
+            {
+                continue;
+            }
+
+            // A buffer being written out by another thread is skipped: its
+            // write(2) completes in the kernel.
+            if (region->tryLock())
+            {
+                writeAll(region->fd,
+                         region->data,
+                         region->size.load(std::memory_order_acquire));
+                region->size.store(0u, std::memory_order_release);
+                if (region->has_footer.exchange(false))
+                {
+                    writeAll(region->fd,
+                             region->footer.data(),
+                             region->footer.size());
+                }
+                region->unlock();
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write p_size bytes, resuming partial writes. Async-signal-safe.
+    //! \return false on error.
+    //-------------------------------------------------------------------------
+    static bool writeAll(int p_fd, const char* p_data, size_t p_size)
+    {
+        while (p_size > 0u)
+        {
+            ssize_t written = ::write(p_fd, p_data, p_size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            p_data += written;
+            p_size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Signal handler: drain the regions then let the previous handler
+    //! process the signal.
+    //-------------------------------------------------------------------------
+    static void onSignal(int p_signal)
+    {
+        const int saved_errno = errno;
+        drain();
+        ::sigaction(p_signal, &s_previous[p_signal], nullptr);
+        s_installed[p_signal].store(false);
+        errno = saved_errno;
+
+        // Delivered once this handler returns (the signal is blocked here).
+        ::raise(p_signal);
+    }
+
+    //! \brief Registered regions
+    static inline std::atomic<Region*> s_regions[MAX_REGIONS] = {};
+    //! \brief Handlers replaced by install(), indexed by signal
+    static inline struct sigaction s_previous[NSIG] = {};
+    //! \brief Signals handled by onSignal(), indexed by signal
+    static inline std::atomic<bool> s_installed[NSIG] = {};
+};
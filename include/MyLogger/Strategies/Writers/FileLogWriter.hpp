@@ -1,13 +1,29 @@
 #pragma once
 
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLevel.hpp"
 #include "MyLogger/Strategies/LogFileFormatter.hpp"
 #include "MyLogger/Strategies/LogWriter.hpp"
+#include "MyLogger/Strategies/Writers/CrashHandler.hpp"
 
-#include <fstream>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
 #include <string>
 
 // *****************************************************************************
 //! \brief Template-based file writer for logging with improved thread safety.
+//!
+//! Records are gathered in a fixed-size buffer holding complete records only
+//! and written with write(2), so that each flush appends whole records (with
+//! FileMode::Append several processes can share the file). The buffer is
+//! registered to the CrashHandler: once CrashHandler::install() has been
+//! called, a fatal signal writes the buffered records and the footer of the
+//! file formatter (pre-formatted when the header is written) instead of
+//! losing them.
 //! \tparam LineFormatterType The type of the line formatter.
 // *****************************************************************************
 template <typename LineFormatterType>
@@ -16,19 +32,24 @@ class FileLogWriter
 {
 public:
 
+    //! \brief Default size of the record buffer.
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64u * 1024u;
+
     //-------------------------------------------------------------------------
     //! \brief Constructor that uses file formatter configuration.
     //! Extracts filename and mode from the file formatter to avoid duplication.
     //! \param p_file_formatter The file formatter containing filename and mode.
+    //! \param p_buffer_size Size of the record buffer.
     //-------------------------------------------------------------------------
     template <typename FileFormatterType>
-    FileLogWriter(FileFormatterType& p_file_formatter)
+    FileLogWriter(FileFormatterType& p_file_formatter,
+                  size_t p_buffer_size = DEFAULT_BUFFER_SIZE)
         : LogWriter<FileLogWriter<LineFormatterType>, LineFormatterType>(
               p_file_formatter.getLineFormatter()),
           m_filename(p_file_formatter.getFilename()),
           m_file_mode(p_file_formatter.getFileMode())
     {
-        openFile();
+        openFile(p_buffer_size);
     }
 
     //-------------------------------------------------------------------------
@@ -36,16 +57,18 @@ public:
     //! \param p_filename The name of the log file.
     //! \param p_line_formatter Reference to the line formatter.
     //! \param p_mode The file mode (defaults to Append).
+    //! \param p_buffer_size Size of the record buffer.
     //-------------------------------------------------------------------------
     FileLogWriter(const std::string& p_filename,
                   LineFormatterType& p_line_formatter,
-                  FileMode p_mode = FileMode::Append)
+                  FileMode p_mode = FileMode::Append,
+                  size_t p_buffer_size = DEFAULT_BUFFER_SIZE)
         : LogWriter<FileLogWriter<LineFormatterType>, LineFormatterType>(
               p_line_formatter),
           m_filename(p_filename),
           m_file_mode(p_mode)
     {
-        openFile();
+        openFile(p_buffer_size);
     }
 
     //-------------------------------------------------------------------------
@@ -53,12 +76,43 @@ public:
     //-------------------------------------------------------------------------
     ~FileLogWriter()
     {
-        if (m_file.is_open())
+        if (m_region.fd >= 0)
         {
-            m_file.close();
+            CrashHandler::unregisterRegion(m_region);
+            flushBuffer();
+            ::close(m_region.fd);
         }
     }
 
+    //-------------------------------------------------------------------------
+    //! \brief Write the header then keep the footer for the crash handler.
+    //! \param p_file_formatter The file formatter.
+    //-------------------------------------------------------------------------
+    template <typename FileFormatterType>
+    void writeHeader(FileFormatterType& p_file_formatter)
+    {
+        LogWriter<FileLogWriter<LineFormatterType>,
+                  LineFormatterType>::writeHeader(p_file_formatter);
+
+        // The footer is set before being published to the signal handler.
+        m_region.has_footer.store(false);
+        m_region.footer = p_file_formatter.footer();
+        m_region.has_footer.store(!m_region.footer.empty(),
+                                  std::memory_order_release);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the footer, which the crash handler must no longer write.
+    //! \param p_file_formatter The file formatter.
+    //-------------------------------------------------------------------------
+    template <typename FileFormatterType>
+    void writeFooter(FileFormatterType& p_file_formatter)
+    {
+        m_region.has_footer.store(false);
+        LogWriter<FileLogWriter<LineFormatterType>,
+                  LineFormatterType>::writeFooter(p_file_formatter);
+    }
+
     //-------------------------------------------------------------------------
     //! \brief Write a complete formatted message.
     //! Called under lock by base class.
@@ -66,10 +120,52 @@ public:
     //-------------------------------------------------------------------------
     void writeImpl(const std::string& p_message)
     {
-        if (m_file.is_open())
+        writeRecordImpl(LogLevel::INFO, p_message, {}, {});
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a record to the buffer, flushing the buffer first when
+    //! the record does not fit. Records larger than the buffer are written
+    //! directly, by a single writev(2) so that they are appended whole.
+    //! Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void writeRecordImpl(LogLevel /*p_level*/,
+                         const std::string& p_begin,
+                         const std::string& p_middle,
+                         const std::string& p_end)
+    {
+        if (m_region.fd < 0)
+        {
+            return;
+        }
+
+        const size_t size = p_begin.size() + p_middle.size() + p_end.size();
+        size_t used = m_region.size.load(std::memory_order_relaxed);
+        if (used + size > m_capacity)
         {
-            m_file << p_message;
+            flushBuffer();
+            used = m_region.size.load(std::memory_order_relaxed);
         }
+
+        if (used + size > m_capacity)
+        {
+            iovec parts[3] = {
+                { const_cast<char*>(p_begin.data()), p_begin.size() },
+                { const_cast<char*>(p_middle.data()), p_middle.size() },
+                { const_cast<char*>(p_end.data()), p_end.size() }
+            };
+            writeParts(m_region.fd, parts, 3);
+            return;
+        }
+
+        // Copy the record then publish it to the crash handler at once.
+        char* output = m_buffer.get() + used;
+        std::memcpy(output, p_begin.data(), p_begin.size());
+        output += p_begin.size();
+        std::memcpy(output, p_middle.data(), p_middle.size());
+        output += p_middle.size();
+        std::memcpy(output, p_end.data(), p_end.size());
+        m_region.size.store(used + size, std::memory_order_release);
     }
 
     //-------------------------------------------------------------------------
@@ -78,10 +174,7 @@ public:
     //-------------------------------------------------------------------------
     void flushImpl()
     {
-        if (m_file.is_open())
-        {
-            m_file.flush();
-        }
+        flushBuffer();
     }
 
     //-------------------------------------------------------------------------
@@ -89,7 +182,7 @@ public:
     //-------------------------------------------------------------------------
     bool isOpen() const
     {
-        return m_file.is_open();
+        return m_region.fd >= 0;
     }
 
     //-------------------------------------------------------------------------
@@ -103,28 +196,95 @@ public:
 private:
 
     //-------------------------------------------------------------------------
-    //! \brief Open the file according to the specified mode.
+    //! \brief Open the file according to the specified mode, allocate the
+    //! buffer and register it to the crash handler.
     //-------------------------------------------------------------------------
-    void openFile()
+    void openFile(size_t p_buffer_size)
     {
-        std::ios_base::openmode mode = std::ios_base::out;
+        int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
 
         if (m_file_mode == FileMode::Append)
         {
-            mode |= std::ios_base::app;
+            flags |= O_APPEND;
         }
         else // FileMode::Create
         {
-            mode |= std::ios_base::trunc;
+            flags |= O_TRUNC;
         }
 
-        m_file.open(m_filename, mode);
+        m_capacity = p_buffer_size;
+        m_buffer = std::make_unique<char[]>(m_capacity);
+        m_region.data = m_buffer.get();
+        m_region.fd = ::open(m_filename.c_str(), flags, 0644);
+        if (m_region.fd >= 0)
+        {
+            CrashHandler::registerRegion(m_region);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the buffered records. Skipped if the crash handler is
+    //! already writing them.
+    //-------------------------------------------------------------------------
+    void flushBuffer()
+    {
+        if (m_region.tryLock())
+        {
+            CrashHandler::writeAll(
+                m_region.fd,
+                m_buffer.get(),
+                m_region.size.load(std::memory_order_relaxed));
+            m_region.size.store(0u, std::memory_order_release);
+            m_region.unlock();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Write the parts of a record with writev(2), resuming partial
+    //! writes (only on error or signal: a regular file takes it whole).
+    //! \return false on error.
+    //-------------------------------------------------------------------------
+    static bool writeParts(int p_fd, iovec* p_parts, int p_count)
+    {
+        while (p_count > 0)
+        {
+            ssize_t written = ::writev(p_fd, p_parts, p_count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+
+            // Skip the parts written, then the written head of the next one.
+            size_t remaining = static_cast<size_t>(written);
+            while ((p_count > 0) && (remaining >= p_parts->iov_len))
+            {
+                remaining -= p_parts->iov_len;
+                ++p_parts;
+                --p_count;
+            }
+            if (p_count > 0)
+            {
+                p_parts->iov_base =
+                    static_cast<char*>(p_parts->iov_base) + remaining;
+                p_parts->iov_len -= remaining;
+            }
+        }
+        return true;
     }
 
-    //! \brief The output file stream
-    std::ofstream m_file;
     //! \brief The filename
     std::string m_filename;
     //! \brief The file mode
     FileMode m_file_mode;
-};
\ No newline at end of file
+    //! \brief Buffer of complete records
+    std::unique_ptr<char[]> m_buffer;
+    //! \brief Size of the buffer
+    size_t m_capacity = 0u;
+    //! \brief File descriptor, buffer and footer shared with the crash
+    //! handler
+    CrashHandler::Region m_region;
+};
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// *****************************************************************************
+//! \brief Length-prefixed framing of records sent over stream sockets.
+//!
+//! Every frame starts with a 6-byte header:
+//! \code
+//! +-----------------------+----------+--------------+--------------------+
+//! | body length (u32, BE) | type(u8) | severity(u8) | body (length bytes)|
+//! +-----------------------+----------+--------------+--------------------+
+//! \endcode
+//! - Record frame: the body is one formatted record (the line formatter
+//!   middle part). The severity is the OpenTelemetry severity number.
+//! - Batch frame: the body is a sequence of complete record frames. The
+//!   severity byte is 0.
+//!
+//! A receiver reads 6 bytes, then exactly `length` bytes: records are never
+//! scanned for a delimiter.
+// *****************************************************************************
+class FrameEncoder
+{
+public:
+
+    //! \brief Size of a frame header.
+    static constexpr size_t HEADER_SIZE = 6u;
+    //! \brief Frame type: a single record.
+    static constexpr uint8_t RECORD = 1u;
+    //! \brief Frame type: a sequence of record frames.
+    static constexpr uint8_t BATCH = 2u;
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a record frame.
+    //! \param p_output The buffer to append to.
+    //! \param p_severity The severity of the record.
+    //! \param p_payload The formatted record.
+    //-------------------------------------------------------------------------
+    static void appendRecord(std::string& p_output,
+                             uint8_t p_severity,
+                             const std::string& p_payload)
+    {
+        appendHeader(p_output,
+                     static_cast<uint32_t>(p_payload.size()),
+                     RECORD,
+                     p_severity);
+        p_output.append(p_payload);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Open a batch frame whose length is patched by closeBatch().
+    //! \param p_output The buffer to append to.
+    //! \return The offset of the batch frame in the buffer.
+    //-------------------------------------------------------------------------
+    static size_t openBatch(std::string& p_output)
+    {
+        size_t offset = p_output.size();
+        appendHeader(p_output, 0u, BATCH, 0u);
+        return offset;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Close a batch frame: everything appended after openBatch() is
+    //! the body of the batch.
+    //! \param p_output The buffer holding the batch frame.
+    //! \param p_offset The offset returned by openBatch().
+    //-------------------------------------------------------------------------
+    static void closeBatch(std::string& p_output, size_t p_offset)
+    {
+        putBigEndian32(&p_output[p_offset],
+                       static_cast<uint32_t>(p_output.size() - p_offset -
+                                             HEADER_SIZE));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Store a 32-bit value in big endian.
+    //-------------------------------------------------------------------------
+    static void putBigEndian32(char* p_output, uint32_t p_value)
+    {
+        p_output[0] = static_cast<char>((p_value >> 24) & 0xFFu);
+        p_output[1] = static_cast<char>((p_value >> 16) & 0xFFu);
+        p_output[2] = static_cast<char>((p_value >> 8) & 0xFFu);
+        p_output[3] = static_cast<char>(p_value & 0xFFu);
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a frame header.
+    //-------------------------------------------------------------------------
+    static void appendHeader(std::string& p_output,
+                             uint32_t p_length,
+                             uint8_t p_type,
+                             uint8_t p_severity)
+    {
+        char header[HEADER_SIZE];
+        putBigEndian32(header, p_length);
+        header[4] = static_cast<char>(p_type);
+        header[5] = static_cast<char>(p_severity);
+        p_output.append(header, HEADER_SIZE);
+    }
+};
+
+// *****************************************************************************
+//! \brief Incremental decoder of the frames produced by FrameEncoder.
+//! Bytes are fed as they are received from the socket; complete records are
+//! handed to a callback, batch frames being unpacked transparently.
+// *****************************************************************************
+class FrameDecoder
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_max_frame_size Frames announcing a larger body are considered
+    //! as a corrupted stream.
+    //-------------------------------------------------------------------------
+    explicit FrameDecoder(size_t p_max_frame_size = 64u * 1024u * 1024u)
+        : m_max_frame_size(p_max_frame_size)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Feed received bytes and decode the complete frames.
+    //! \param p_data The received bytes.
+    //! \param p_size The number of received bytes.
+    //! \param p_on_record Callable invoked as f(uint8_t severity,
+    //! const char* data, size_t size) for each record.
+    //! \return false if the stream is corrupted.
+    //-------------------------------------------------------------------------
+    template <typename Callback>
+    bool feed(const char* p_data, size_t p_size, Callback&& p_on_record)
+    {
+        m_buffer.append(p_data, p_size);
+
+        size_t offset = 0u;
+        bool valid = true;
+        while (m_buffer.size() - offset >= FrameEncoder::HEADER_SIZE)
+        {
+            const size_t length = readBigEndian32(m_buffer.data() + offset);
+            if (length > m_max_frame_size)
+            {
+                valid = false;
+                break;
+            }
+            const size_t frame_size = FrameEncoder::HEADER_SIZE + length;
+            if (m_buffer.size() - offset < frame_size)
+            {
+                break;
+            }
+            if (!decode(m_buffer.data() + offset, frame_size, p_on_record))
+            {
+                valid = false;
+                break;
+            }
+            offset += frame_size;
+        }
+
+        m_buffer.erase(0u, valid ? offset : m_buffer.size());
+        return valid;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Decode a buffer holding complete frames only.
+    //! \return false if the buffer does not hold a sequence of valid frames.
+    //-------------------------------------------------------------------------
+    template <typename Callback>
+    static bool
+    decode(const char* p_data, size_t p_size, Callback&& p_on_record)
+    {
+        size_t offset = 0u;
+        while (offset < p_size)
+        {
+            if (p_size - offset < FrameEncoder::HEADER_SIZE)
+            {
+                return false;
+            }
+
+            const char* header = p_data + offset;
+            const size_t length = readBigEndian32(header);
+            const auto type = static_cast<uint8_t>(header[4]);
+            const auto severity = static_cast<uint8_t>(header[5]);
+            const char* body = header + FrameEncoder::HEADER_SIZE;
+            if (p_size - offset - FrameEncoder::HEADER_SIZE < length)
+            {
+                return false;
+            }
+
+            if (type == FrameEncoder::RECORD)
+            {
+                p_on_record(severity, body, length);
+            }
+            else if (type == FrameEncoder::BATCH)
+            {
+                if (!decode(body, length, p_on_record))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                return false;
+            }
+            offset += FrameEncoder::HEADER_SIZE + length;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read a 32-bit big endian value.
+    //-------------------------------------------------------------------------
+    static uint32_t readBigEndian32(const char* p_input)
+    {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(p_input);
+        return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) |
+               (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+    }
+
+private:
+
+    //! \brief Bytes of the incomplete frame
+    std::string m_buffer;
+    //! \brief Largest accepted frame body
+    size_t m_max_frame_size;
+};
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "MyLogger/Strategies/LogFileFormatter.hpp"
+#include "MyLogger/Strategies/LogWriter.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// *****************************************************************************
+//! \brief Template-based file writer compressing logs into gzip frames.
+//!
+//! Records are accumulated until the frame size is reached, then deflated into
+//! an independent gzip member appended to the file. Frames always end on a
+//! record boundary. The whole file stays a valid gzip stream (zcat, gunzip)
+//! while each member can be decompressed on its own.
+//!
+//! To make frames seekable, each gzip header carries an extra subfield 'ML'
+//! (4 bytes, little endian) holding the total size of the member. A reader
+//! can therefore hop from frame to frame by reading headers only, and read
+//! the uncompressed size of the frame from the ISIZE field of its trailer.
+//!
+//! Link against zlib (-lz) when using this writer.
+//! \tparam LineFormatterType The type of the line formatter.
+// *****************************************************************************
+template <typename LineFormatterType>
+class GzipFileLogWriter
+    : public LogWriter<GzipFileLogWriter<LineFormatterType>, LineFormatterType>
+{
+public:
+
+    //! \brief Default uncompressed size of a frame before it is compressed.
+    static constexpr size_t DEFAULT_FRAME_SIZE = 64u * 1024u;
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor that uses file formatter configuration.
+    //! \param p_file_formatter The file formatter containing filename and mode.
+    //! \param p_frame_size Uncompressed size triggering the compression of a
+    //! frame.
+    //! \param p_compression_level zlib compression level (0-9).
+    //-------------------------------------------------------------------------
+    template <typename FileFormatterType>
+    explicit GzipFileLogWriter(FileFormatterType& p_file_formatter,
+                               size_t p_frame_size = DEFAULT_FRAME_SIZE,
+                               int p_compression_level = Z_DEFAULT_COMPRESSION)
+        : LogWriter<GzipFileLogWriter<LineFormatterType>, LineFormatterType>(
+              p_file_formatter.getLineFormatter()),
+          m_filename(p_file_formatter.getFilename()),
+          m_file_mode(p_file_formatter.getFileMode()),
+          m_frame_size(p_frame_size)
+    {
+        openFile(p_compression_level);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_filename The name of the compressed log file.
+    //! \param p_line_formatter Reference to the line formatter.
+    //! \param p_mode The file mode (defaults to Append).
+    //! \param p_frame_size Uncompressed size triggering the compression of a
+    //! frame.
+    //! \param p_compression_level zlib compression level (0-9).
+    //-------------------------------------------------------------------------
+    GzipFileLogWriter(const std::string& p_filename,
+                      LineFormatterType& p_line_formatter,
+                      FileMode p_mode = FileMode::Append,
+                      size_t p_frame_size = DEFAULT_FRAME_SIZE,
+                      int p_compression_level = Z_DEFAULT_COMPRESSION)
+        : LogWriter<GzipFileLogWriter<LineFormatterType>, LineFormatterType>(
+              p_line_formatter),
+          m_filename(p_filename),
+          m_file_mode(p_mode),
+          m_frame_size(p_frame_size)
+    {
+        openFile(p_compression_level);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Destructor. Compresses the pending frame.
+    //-------------------------------------------------------------------------
+    ~GzipFileLogWriter()
+    {
+        compressFrame();
+        if (m_zstream_ready)
+        {
+            deflateEnd(&m_zstream);
+        }
+        if (m_file.is_open())
+        {
+            m_file.close();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a message (header, footer) to the pending frame.
+    //! Called under lock by base class.
+    //! \param p_message The message to write.
+    //-------------------------------------------------------------------------
+    void writeImpl(const std::string& p_message)
+    {
+        m_frame.append(p_message);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Append a record to the pending frame and compress the frame
+    //! once it is full. Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void writeRecordImpl(LogLevel /*p_level*/,
+                         const std::string& p_begin,
+                         const std::string& p_middle,
+                         const std::string& p_end)
+    {
+        m_frame.append(p_begin).append(p_middle).append(p_end);
+        ++m_frame_records;
+        if (m_frame.size() >= m_frame_size)
+        {
+            compressFrame();
+            this->reportDroppedRecords(m_dropped_records);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Compress the pending frame and flush the file.
+    //! Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void flushImpl()
+    {
+        compressFrame();
+        this->reportDroppedRecords(m_dropped_records);
+        if (m_file.is_open())
+        {
+            m_file.flush();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the file is open.
+    //-------------------------------------------------------------------------
+    bool isOpen() const
+    {
+        return m_file.is_open() && m_zstream_ready;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the current filename.
+    //-------------------------------------------------------------------------
+    const std::string& getFilename() const
+    {
+        return m_filename;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of uncompressed bytes written in frames.
+    //-------------------------------------------------------------------------
+    uint64_t getUncompressedBytes() const
+    {
+        return m_uncompressed_bytes;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of compressed bytes written to the file.
+    //-------------------------------------------------------------------------
+    uint64_t getCompressedBytes() const
+    {
+        return m_compressed_bytes;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of frames written to the file.
+    //-------------------------------------------------------------------------
+    uint64_t getFrameCount() const
+    {
+        return m_frame_count;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of records dropped because their frame could
+    //! not be compressed.
+    //-------------------------------------------------------------------------
+    uint64_t getDroppedRecords() const
+    {
+        return m_dropped_records;
+    }
+
+private:
+
+    //! \brief Size of the gzip header including the 'ML' extra subfield.
+    static constexpr size_t HEADER_SIZE = 10u + 2u + 8u;
+    //! \brief Size of the gzip trailer (CRC32 + ISIZE).
+    static constexpr size_t TRAILER_SIZE = 8u;
+
+    //-------------------------------------------------------------------------
+    //! \brief Open the file according to the specified mode and prepare the
+    //! raw deflate stream reused by all frames.
+    //-------------------------------------------------------------------------
+    void openFile(int p_compression_level)
+    {
+        std::ios_base::openmode mode = std::ios_base::out |
+                                       std::ios_base::binary;
+
+        if (m_file_mode == FileMode::Append)
+        {
+            mode |= std::ios_base::app;
+        }
+        else // FileMode::Create
+        {
+            mode |= std::ios_base::trunc;
+        }
+
+        m_file.open(m_filename, mode);
+        m_frame.reserve(m_frame_size + m_frame_size / 4u);
+
+        // Negative window bits: raw deflate, the gzip wrapper is ours.
+        m_zstream_ready = deflateInit2(&m_zstream,
+                                       p_compression_level,
+                                       Z_DEFLATED,
+                                       -MAX_WBITS,
+                                       8,
+                                       Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Compress the pending frame as an independent gzip member.
+    //! When the file is not open or deflate fails, the frame is dropped
+    //! rather than kept growing.
+    //-------------------------------------------------------------------------
+    void compressFrame()
+    {
+        if (m_frame.empty())
+        {
+            return;
+        }
+        if (!m_zstream_ready || !m_file.is_open())
+        {
+            dropFrame();
+            return;
+        }
+
+        deflateReset(&m_zstream);
+        const auto input_size = static_cast<uLong>(m_frame.size());
+        const size_t bound = deflateBound(&m_zstream, input_size);
+        m_compressed.resize(HEADER_SIZE + bound + TRAILER_SIZE);
+
+        auto* output = reinterpret_cast<Bytef*>(&m_compressed[0]);
+        m_zstream.next_in =
+            reinterpret_cast<Bytef*>(const_cast<char*>(m_frame.data()));
+        m_zstream.avail_in = static_cast<uInt>(input_size);
+        m_zstream.next_out = output + HEADER_SIZE;
+        m_zstream.avail_out = static_cast<uInt>(bound);
+        if (deflate(&m_zstream, Z_FINISH) != Z_STREAM_END)
+        {
+            dropFrame();
+            return;
+        }
+
+        const size_t deflated_size = bound - m_zstream.avail_out;
+        const size_t member_size = HEADER_SIZE + deflated_size + TRAILER_SIZE;
+        const uLong crc = crc32(
+            0u,
+            reinterpret_cast<const Bytef*>(m_frame.data()),
+            static_cast<uInt>(input_size));
+
+        // Gzip header: magic, deflate, FEXTRA flag, no mtime, unknown OS.
+        const unsigned char header[10] = { 0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0,
+                                           255 };
+        std::copy(header, header + 10, output);
+        putLittleEndian16(output + 10, 8u); // XLEN
+        output[12] = 'M';
+        output[13] = 'L';
+        putLittleEndian16(output + 14, 4u);
+        putLittleEndian32(output + 16, static_cast<uint32_t>(member_size));
+
+        Bytef* trailer = output + HEADER_SIZE + deflated_size;
+        putLittleEndian32(trailer, static_cast<uint32_t>(crc));
+        putLittleEndian32(trailer + 4, static_cast<uint32_t>(input_size));
+
+        m_file.write(m_compressed.data(),
+                     static_cast<std::streamsize>(member_size));
+
+        m_uncompressed_bytes += input_size;
+        m_compressed_bytes += member_size;
+        ++m_frame_count;
+        m_frame_records = 0u;
+        m_frame.clear();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Discard the pending frame and count its records as dropped.
+    //-------------------------------------------------------------------------
+    void dropFrame()
+    {
+        m_dropped_records += m_frame_records;
+        m_frame_records = 0u;
+        m_frame.clear();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Store a 16-bit value in little endian.
+    //-------------------------------------------------------------------------
+    static void putLittleEndian16(Bytef* p_output, uint32_t p_value)
+    {
+        p_output[0] = static_cast<Bytef>(p_value & 0xFFu);
+        p_output[1] = static_cast<Bytef>((p_value >> 8) & 0xFFu);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Store a 32-bit value in little endian.
+    //-------------------------------------------------------------------------
+    static void putLittleEndian32(Bytef* p_output, uint32_t p_value)
+    {
+        putLittleEndian16(p_output, p_value & 0xFFFFu);
+        putLittleEndian16(p_output + 2, p_value >> 16);
+    }
+
+    //! \brief The output file stream
+    std::ofstream m_file;
+    //! \brief The filename
+    std::string m_filename;
+    //! \brief The file mode
+    FileMode m_file_mode;
+    //! \brief Uncompressed size triggering the compression of a frame
+    size_t m_frame_size;
+    //! \brief Pending uncompressed records
+    std::string m_frame;
+    //! \brief Number of records in the pending frame
+    uint64_t m_frame_records = 0u;
+    //! \brief Compressed gzip member (reused between frames)
+    std::string m_compressed;
+    //! \brief Raw deflate stream (reused between frames)
+    z_stream m_zstream{};
+    //! \brief Whether the deflate stream has been initialized
+    bool m_zstream_ready = false;
+    //! \brief Statistics: uncompressed bytes
+    uint64_t m_uncompressed_bytes = 0u;
+    //! \brief Statistics: compressed bytes
+    uint64_t m_compressed_bytes = 0u;
+    //! \brief Statistics: number of frames
+    uint64_t m_frame_count = 0u;
+    //! \brief Statistics: records of the frames that failed to compress
+    uint64_t m_dropped_records = 0u;
+};
@@ -0,0 +1,660 @@
+#pragma once
+
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLevel.hpp"
+#include "MyLogger/Strategies/LogWriter.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// *****************************************************************************
+//! \brief Template-based writer delivering each record to several writers
+//! (file, console, socket ...) while formatting it only once.
+//!
+//! The body of a record (the middle part of the line formatter, which holds
+//! all the costly work) is formatted once, on the logging thread (so the
+//! lazy attributes of the trace are computed there, see
+//! Trace::addAttribute()), into an immutable shared buffer.
+//! Every sink then receives a reference to this buffer through its own
+//! bounded queue, and a worker thread per sink writes it with the sink
+//! writer. The begin and end parts are cheap and are formatted by each sink,
+//! which tracks its own first line, so that level filtering does not break
+//! documents such as the JSON array of the OpenTelemetry file formatter.
+//!
+//! Each sink has a minimum level. Records below the level of every sink are
+//! not formatted at all. When the queue of a sink is full, the record is
+//! dropped for this sink only and counted: a slow sink never blocks the
+//! logging threads nor the other sinks. File headers and footers, as well as
+//! flushes, are delivered to every sink and are never dropped. Sink writers
+//! receive them through their own writeHeader() and writeFooter(), so that
+//! a FileLogWriter sink keeps the footer for the crash handler.
+//!
+//! Sinks shall be added before the writer is given to the Logger, which
+//! writes the file header from its constructor. Sink writers are only used
+//! by their worker thread and their line formatter is used concurrently by
+//! the workers: its begin and end formatting shall not alter its state.
+//! Line formatters whose records depend on the previous ones (see
+//! LogLineFormatter::HAS_OUTPUT_STATE) are rejected.
+//! \tparam LineFormatterType The type of the line formatter.
+// *****************************************************************************
+template <typename LineFormatterType>
+class MultiSinkLogWriter
+    : public LogWriter<MultiSinkLogWriter<LineFormatterType>, LineFormatterType>
+{
+    using Base =
+        LogWriter<MultiSinkLogWriter<LineFormatterType>, LineFormatterType>;
+
+    static_assert(!LineFormatterType::HAS_OUTPUT_STATE,
+                  "The records of this line formatter depend on the previous "
+                  "ones: they cannot be filtered nor dropped per sink");
+
+public:
+
+    //! \brief Default capacity of the queue of a sink (in records).
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 4096u;
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_line_formatter Reference to the line formatter shared by all
+    //! the sinks.
+    //-------------------------------------------------------------------------
+    explicit MultiSinkLogWriter(LineFormatterType& p_line_formatter)
+        : Base(p_line_formatter), m_line_formatter(p_line_formatter)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Destructor. Each sink writes its pending records before its
+    //! worker thread is stopped.
+    //-------------------------------------------------------------------------
+    ~MultiSinkLogWriter() = default;
+
+    //-------------------------------------------------------------------------
+    //! \brief Add a sink.
+    //! \param p_writer The writer of the sink.
+    //! \param p_min_level Records below this level are not delivered to this
+    //! sink.
+    //! \param p_queue_capacity Maximum number of records waiting for the
+    //! sink worker.
+    //! \return The index of the sink.
+    //-------------------------------------------------------------------------
+    template <typename WriterType>
+    size_t addSink(std::unique_ptr<WriterType> p_writer,
+                   LogLevel p_min_level = LogLevel::TRACE,
+                   size_t p_queue_capacity = DEFAULT_QUEUE_CAPACITY)
+    {
+        m_sinks.push_back(std::make_unique<WriterSink<WriterType>>(
+            std::move(p_writer),
+            m_line_formatter,
+            p_min_level,
+            p_queue_capacity));
+        if ((m_sinks.size() == 1u) ||
+            (severity(p_min_level) < severity(m_min_level)))
+        {
+            m_min_level = p_min_level;
+        }
+        return m_sinks.size() - 1u;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Format the body of a record once and queue it to the sinks
+    //! accepting its level. Shadows LogWriter::writeLine.
+    //! \param p_level The log level.
+    //! \param p_trace The trace containing log data.
+    //-------------------------------------------------------------------------
+    void writeLine(LogLevel p_level, const Trace& p_trace)
+    {
+        if (!isAccepted(p_level))
+        {
+            return;
+        }
+        MYLOGGER_ALLOCATION_SCOPE(Writer);
+        const auto started = this->startTimer();
+        p_trace.resolveAttributes(true);
+        dispatch(p_level,
+                 std::make_shared<const std::string>(
+                     m_line_formatter.formatMiddle(p_trace)),
+                 started);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Format a single span once and queue it to the sinks accepting
+    //! its level. Shadows LogWriter::writeSpan.
+    //! \param p_level The log level.
+    //! \param p_span The ended span.
+    //-------------------------------------------------------------------------
+    void writeSpan(LogLevel p_level, const Trace& p_span)
+    {
+        if (!isAccepted(p_level))
+        {
+            return;
+        }
+        MYLOGGER_ALLOCATION_SCOPE(Writer);
+        const auto started = this->startTimer();
+        p_span.resolveAttributes(false);
+        dispatch(p_level,
+                 std::make_shared<const std::string>(
+                     m_line_formatter.formatSpan(p_span)),
+                 started);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Queue a pre-formatted message to the sinks accepting its level.
+    //! Shadows LogWriter::writeLine.
+    //! \param p_level The log level.
+    //! \param p_message The formatted message to write.
+    //-------------------------------------------------------------------------
+    void writeLine(LogLevel p_level, const std::string& p_message)
+    {
+        if (!isAccepted(p_level))
+        {
+            return;
+        }
+        MYLOGGER_ALLOCATION_SCOPE(Writer);
+        const auto started = this->startTimer();
+        dispatch(p_level,
+                 std::make_shared<const std::string>(p_message),
+                 started);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Deliver the header to every sink, along with the footer, so
+    //! that each sink writer gets both as from the file formatter (i.e.
+    //! FileLogWriter keeps the footer for the crash handler). Shadows
+    //! LogWriter::writeHeader.
+    //! \param p_file_formatter The file formatter.
+    //-------------------------------------------------------------------------
+    template <typename FileFormatterType>
+    void writeHeader(FileFormatterType& p_file_formatter)
+    {
+        push(Item::Type::Header, p_file_formatter);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Deliver the footer to every sink. Shadows
+    //! LogWriter::writeFooter.
+    //! \param p_file_formatter The file formatter.
+    //-------------------------------------------------------------------------
+    template <typename FileFormatterType>
+    void writeFooter(FileFormatterType& p_file_formatter)
+    {
+        push(Item::Type::Footer, p_file_formatter);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Deliver a message to every sink, as is.
+    //! Called under lock by base class.
+    //! \param p_message The message to write.
+    //-------------------------------------------------------------------------
+    void writeImpl(const std::string& p_message)
+    {
+        auto message = std::make_shared<const std::string>(p_message);
+        for (auto& sink : m_sinks)
+        {
+            sink->pushRaw(Item::Type::Raw, message, nullptr);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Wait until every sink has written and flushed the records
+    //! queued so far. Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void flushImpl()
+    {
+        for (auto& sink : m_sinks)
+        {
+            sink->flush();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of sinks.
+    //-------------------------------------------------------------------------
+    size_t getSinkCount() const
+    {
+        return m_sinks.size();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of records dropped by a sink because its queue
+    //! was full.
+    //! \param p_sink The index returned by addSink().
+    //-------------------------------------------------------------------------
+    uint64_t getDroppedRecords(size_t p_sink) const
+    {
+        return m_sinks[p_sink]->getDroppedRecords();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of records skipped because no sink accepted
+    //! their level (these records are not formatted).
+    //-------------------------------------------------------------------------
+    uint64_t getFilteredRecords() const
+    {
+        return m_filtered_records;
+    }
+
+private:
+
+    //! \brief Immutable formatted record shared by the sinks.
+    using SharedText = std::shared_ptr<const std::string>;
+
+    //! \brief Queued operation.
+    struct Item
+    {
+        enum class Type
+        {
+            Record, //!< A record to frame with begin and end
+            Raw,    //!< A message written as is
+            Header, //!< A file header, with the footer of the file
+            Footer, //!< A file footer
+            Flush   //!< A flush request
+        };
+
+        Type type;
+        LogLevel level;
+        SharedText text;
+        //! \brief Footer of the file (Header and Footer items only)
+        SharedText footer;
+    };
+
+    // *************************************************************************
+    //! \brief File formatter replaying a header and a footer formatted on the
+    //! logging thread, given to the sink writers.
+    // *************************************************************************
+    struct FormattedFile
+    {
+        std::string header() const
+        {
+            return text ? *text : std::string();
+        }
+
+        std::string footer() const
+        {
+            return *footer_text;
+        }
+
+        //! \brief The header (nullptr when writing the footer)
+        const std::string* text;
+        //! \brief The footer
+        const std::string* footer_text;
+    };
+
+    // *************************************************************************
+    //! \brief Queue and worker thread of a sink. The writer is hidden behind
+    //! the virtual methods implemented by WriterSink.
+    // *************************************************************************
+    class Sink
+    {
+    public:
+
+        Sink(LineFormatterType& p_line_formatter,
+             LogLevel p_min_level,
+             size_t p_queue_capacity)
+            : m_line_formatter(p_line_formatter),
+              m_min_level(p_min_level),
+              m_queue_capacity(p_queue_capacity)
+        {
+        }
+
+        virtual ~Sink() = default;
+
+        //---------------------------------------------------------------------
+        //! \brief Check if the sink accepts records of the given level.
+        //---------------------------------------------------------------------
+        bool accepts(LogLevel p_level) const
+        {
+            return severity(p_level) >= severity(m_min_level);
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Queue a record, or drop it if the queue is full.
+        //! \return The number of records in the queue after the push, 0 if
+        //! the record has been dropped.
+        //---------------------------------------------------------------------
+        size_t pushRecord(LogLevel p_level, const SharedText& p_text)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_records_in_queue >= m_queue_capacity)
+            {
+                ++m_dropped_records;
+                return 0u;
+            }
+            const size_t depth = ++m_records_in_queue;
+            m_queue.push_back(
+                { Item::Type::Record, p_level, p_text, nullptr });
+            lock.unlock();
+            m_wake_worker.notify_one();
+            return depth;
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Queue a header, a footer or a message written as is. Never
+        //! dropped.
+        //---------------------------------------------------------------------
+        void pushRaw(typename Item::Type p_type,
+                     const SharedText& p_text,
+                     const SharedText& p_footer)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queue.push_back({ p_type, LogLevel::TRACE, p_text, p_footer });
+            lock.unlock();
+            m_wake_worker.notify_one();
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Queue a flush and wait until the worker performed it.
+        //---------------------------------------------------------------------
+        void flush()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            const uint64_t ticket = ++m_flush_requested;
+            m_queue.push_back(
+                { Item::Type::Flush, LogLevel::TRACE, nullptr, nullptr });
+            m_wake_worker.notify_one();
+            m_flushed.wait(lock, [&] { return m_flush_done >= ticket; });
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Get the number of records dropped because the queue was
+        //! full.
+        //---------------------------------------------------------------------
+        uint64_t getDroppedRecords() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_dropped_records;
+        }
+
+    protected:
+
+        //---------------------------------------------------------------------
+        //! \brief Start the worker. Called by the derived constructor, once
+        //! the writer exists.
+        //---------------------------------------------------------------------
+        void start()
+        {
+            m_worker = std::thread(&Sink::run, this);
+        }
+
+        //---------------------------------------------------------------------
+        //! \brief Write the pending records, flush the writer and join the
+        //! worker. Called by the derived destructor, before the writer is
+        //! destroyed.
+        //---------------------------------------------------------------------
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_wake_worker.notify_one();
+            if (m_worker.joinable())
+            {
+                m_worker.join();
+            }
+        }
+
+        virtual void writeRecord(LogLevel p_level,
+                                 const std::string& p_begin,
+                                 const std::string& p_middle,
+                                 const std::string& p_end) = 0;
+        virtual void writeRaw(const std::string& p_text) = 0;
+        virtual void writeHeader(const FormattedFile& p_file) = 0;
+        virtual void writeFooter(const FormattedFile& p_file) = 0;
+        virtual void flushWriter() = 0;
+
+    private:
+
+        //---------------------------------------------------------------------
+        //! \brief Worker loop: takes the whole queue at once and writes it
+        //! without holding the lock.
+        //---------------------------------------------------------------------
+        void run()
+        {
+            std::deque<Item> items;
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wake_worker.wait(
+                        lock, [&] { return m_stopping || !m_queue.empty(); });
+                    if (m_queue.empty())
+                    {
+                        break; // Stopping with nothing left to write
+                    }
+                    items.swap(m_queue);
+                    m_records_in_queue = 0u;
+                }
+
+                uint64_t flushes = 0u;
+                for (const Item& item : items)
+                {
+                    switch (item.type)
+                    {
+                        case Item::Type::Record:
+                            writeRecord(item.level,
+                                        m_line_formatter.formatBegin(
+                                            item.level, m_is_first_line),
+                                        *item.text,
+                                        m_line_formatter.formatEnd());
+                            m_is_first_line = false;
+                            break;
+                        case Item::Type::Raw:
+                            writeRaw(*item.text);
+                            break;
+                        case Item::Type::Header:
+                            writeHeader({ item.text.get(), item.footer.get() });
+                            break;
+                        case Item::Type::Footer:
+                            writeFooter({ nullptr, item.footer.get() });
+                            break;
+                        case Item::Type::Flush:
+                            flushWriter();
+                            ++flushes;
+                            break;
+                    }
+                }
+                items.clear();
+
+                if (flushes > 0u)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_flush_done += flushes;
+                    }
+                    m_flushed.notify_all();
+                }
+            }
+            flushWriter();
+        }
+
+        //! \brief Line formatter for the begin and end parts
+        LineFormatterType& m_line_formatter;
+        //! \brief Records below this level are not delivered
+        LogLevel m_min_level;
+        //! \brief Maximum number of records in the queue
+        size_t m_queue_capacity;
+        //! \brief Protects the queue and the counters
+        mutable std::mutex m_mutex;
+        //! \brief Signals the worker that the queue is not empty
+        std::condition_variable m_wake_worker;
+        //! \brief Signals the flushing threads that a flush was performed
+        std::condition_variable m_flushed;
+        //! \brief Operations waiting for the worker
+        std::deque<Item> m_queue;
+        //! \brief Number of records (not headers nor flushes) in the queue
+        size_t m_records_in_queue = 0u;
+        //! \brief Number of records dropped because the queue was full
+        uint64_t m_dropped_records = 0u;
+        //! \brief Number of flushes requested
+        uint64_t m_flush_requested = 0u;
+        //! \brief Number of flushes performed by the worker
+        uint64_t m_flush_done = 0u;
+        //! \brief The worker shall exit once the queue is empty
+        bool m_stopping = false;
+        //! \brief No record has been written by this sink yet (worker only)
+        bool m_is_first_line = true;
+        //! \brief The worker thread
+        std::thread m_worker;
+    };
+
+    // *************************************************************************
+    //! \brief Sink owning a writer of a given type.
+    // *************************************************************************
+    template <typename WriterType>
+    class WriterSink final : public Sink
+    {
+    public:
+
+        WriterSink(std::unique_ptr<WriterType> p_writer,
+                   LineFormatterType& p_line_formatter,
+                   LogLevel p_min_level,
+                   size_t p_queue_capacity)
+            : Sink(p_line_formatter, p_min_level, p_queue_capacity),
+              m_writer(std::move(p_writer))
+        {
+            this->start();
+        }
+
+        ~WriterSink() override
+        {
+            this->stop();
+        }
+
+    private:
+
+        void writeRecord(LogLevel p_level,
+                         const std::string& p_begin,
+                         const std::string& p_middle,
+                         const std::string& p_end) override
+        {
+            m_writer->writeRecordImpl(p_level, p_begin, p_middle, p_end);
+        }
+
+        void writeRaw(const std::string& p_text) override
+        {
+            m_writer->writeImpl(p_text);
+        }
+
+        void writeHeader(const FormattedFile& p_file) override
+        {
+            m_writer->writeHeader(p_file);
+        }
+
+        void writeFooter(const FormattedFile& p_file) override
+        {
+            m_writer->writeFooter(p_file);
+        }
+
+        void flushWriter() override
+        {
+            m_writer->flushImpl();
+        }
+
+        //! \brief The writer, only used by the worker thread
+        std::unique_ptr<WriterType> m_writer;
+    };
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the severity number of a level.
+    //-------------------------------------------------------------------------
+    static uint8_t severity(LogLevel p_level)
+    {
+        return static_cast<uint8_t>(p_level);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Format the header and the footer of a file formatter once and
+    //! queue them to every sink.
+    //! \param p_type Header or Footer.
+    //-------------------------------------------------------------------------
+    template <typename FileFormatterType>
+    void push(typename Item::Type p_type, FileFormatterType& p_file_formatter)
+    {
+        SharedText header;
+        if (p_type == Item::Type::Header)
+        {
+            header = std::make_shared<const std::string>(
+                p_file_formatter.header());
+        }
+        auto footer =
+            std::make_shared<const std::string>(p_file_formatter.footer());
+        for (auto& sink : m_sinks)
+        {
+            sink->pushRaw(p_type, header, footer);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if at least one sink accepts the level.
+    //-------------------------------------------------------------------------
+    bool isAccepted(LogLevel p_level)
+    {
+        if (m_sinks.empty() || (severity(p_level) < severity(m_min_level)))
+        {
+            ++m_filtered_records;
+            return false;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Queue a formatted record to the sinks accepting its level.
+    //! When metrics are enabled, the record is accounted for once with the
+    //! size of its body, and the queue depths and drops of every sink are
+    //! reported.
+    //! \param p_started Time the formatting started (see startTimer()).
+    //-------------------------------------------------------------------------
+    void dispatch(LogLevel p_level,
+                  const SharedText& p_text,
+                  LoggerMetrics::Clock::time_point p_started)
+    {
+        LoggerMetrics* metrics = this->getMetrics();
+        if (metrics == nullptr)
+        {
+            for (auto& sink : m_sinks)
+            {
+                if (sink->accepts(p_level))
+                {
+                    sink->pushRecord(p_level, p_text);
+                }
+            }
+            return;
+        }
+
+        const auto formatted = LoggerMetrics::Clock::now();
+        for (auto& sink : m_sinks)
+        {
+            if (sink->accepts(p_level))
+            {
+                const size_t depth = sink->pushRecord(p_level, p_text);
+                if (depth == 0u)
+                {
+                    metrics->onDropped();
+                }
+                else
+                {
+                    metrics->onQueueDepth(depth);
+                }
+            }
+        }
+        metrics->onRecord(p_level,
+                          p_text->size(),
+                          formatted - p_started,
+                          LoggerMetrics::Clock::now() - formatted);
+    }
+
+    //! \brief The line formatter shared by the sinks
+    LineFormatterType& m_line_formatter;
+    //! \brief The sinks
+    std::vector<std::unique_ptr<Sink>> m_sinks;
+    //! \brief Lowest minimum level of the sinks
+    LogLevel m_min_level = LogLevel::TRACE;
+    //! \brief Number of records no sink accepted
+    uint64_t m_filtered_records = 0u;
+};
@@ -0,0 +1,1021 @@
+#pragma once
+
+#include "MyLogger/Strategies/Writers/FrameProtocol.hpp"
+#include "MyLogger/Strategies/Writers/SocketWriterConfig.hpp"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#    include <sys/epoll.h>
+#    define MYLOGGER_HAS_EPOLL 1
+#    include <linux/errqueue.h>
+#    if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#        define MYLOGGER_HAS_ZEROCOPY 1
+#    endif
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+// *****************************************************************************
+//! \brief Resolved address of a socket peer.
+// *****************************************************************************
+struct SocketAddress
+{
+    //! \brief The address, large enough for any family.
+    sockaddr_storage storage{};
+    //! \brief The used size of storage (0 if the address is invalid).
+    socklen_t length = 0;
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the address has been resolved.
+    //-------------------------------------------------------------------------
+    bool isValid() const
+    {
+        return length != 0;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the address family (AF_INET, AF_INET6, AF_UNIX).
+    //-------------------------------------------------------------------------
+    int family() const
+    {
+        return storage.ss_family;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Resolve a host name or a numeric address.
+    //! \param p_host The host name.
+    //! \param p_port The port.
+    //! \param p_socket_type SOCK_STREAM or SOCK_DGRAM.
+    //-------------------------------------------------------------------------
+    static SocketAddress fromHost(const std::string& p_host,
+                                  unsigned short p_port,
+                                  int p_socket_type)
+    {
+        SocketAddress address;
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = p_socket_type;
+
+        addrinfo* result = nullptr;
+        const std::string port = std::to_string(p_port);
+        if (::getaddrinfo(p_host.c_str(), port.c_str(), &hints, &result) == 0)
+        {
+            std::memcpy(&address.storage, result->ai_addr, result->ai_addrlen);
+            address.length = result->ai_addrlen;
+            ::freeaddrinfo(result);
+        }
+        return address;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Make the address of a Unix domain socket.
+    //! \param p_path The path of the socket file.
+    //-------------------------------------------------------------------------
+    static SocketAddress fromUnixPath(const std::string& p_path)
+    {
+        SocketAddress address;
+        sockaddr_un unix_address{};
+        if (p_path.size() < sizeof(unix_address.sun_path))
+        {
+            unix_address.sun_family = AF_UNIX;
+            std::memcpy(unix_address.sun_path, p_path.c_str(), p_path.size());
+            std::memcpy(&address.storage, &unix_address, sizeof(unix_address));
+            address.length = static_cast<socklen_t>(sizeof(unix_address));
+        }
+        return address;
+    }
+};
+
+// *****************************************************************************
+//! \brief Owner of a non-blocking POSIX socket descriptor.
+//! On Linux, writability is watched with an epoll instance bound to the
+//! socket; other systems use poll().
+// *****************************************************************************
+class PosixSocket
+{
+public:
+
+    PosixSocket() = default;
+    PosixSocket(const PosixSocket&) = delete;
+    PosixSocket& operator=(const PosixSocket&) = delete;
+
+    //-------------------------------------------------------------------------
+    //! \brief Destructor. Closes the socket.
+    //-------------------------------------------------------------------------
+    ~PosixSocket()
+    {
+        close();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Create a non-blocking socket, closing the previous one.
+    //! \param p_family The address family.
+    //! \param p_type SOCK_STREAM or SOCK_DGRAM.
+    //! \return true if the socket was created.
+    //-------------------------------------------------------------------------
+    bool open(int p_family, int p_type)
+    {
+        close();
+        m_fd = ::socket(p_family, p_type, 0);
+        if (m_fd < 0)
+        {
+            return false;
+        }
+
+        ::fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL, 0) | O_NONBLOCK);
+#if defined(SO_NOSIGPIPE)
+        setOption(SOL_SOCKET, SO_NOSIGPIPE, 1);
+#endif
+#if defined(MYLOGGER_HAS_EPOLL)
+        m_epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+        epoll_event event{};
+        event.events = EPOLLOUT;
+        event.data.fd = m_fd;
+        ::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_fd, &event);
+#endif
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Close the socket.
+    //-------------------------------------------------------------------------
+    void close()
+    {
+#if defined(MYLOGGER_HAS_EPOLL)
+        if (m_epoll_fd >= 0)
+        {
+            ::close(m_epoll_fd);
+            m_epoll_fd = -1;
+        }
+#endif
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Set an integer socket option.
+    //! \return true on success.
+    //-------------------------------------------------------------------------
+    bool setOption(int p_level, int p_option, int p_value) const
+    {
+        return ::setsockopt(
+                   m_fd, p_level, p_option, &p_value, sizeof(p_value)) == 0;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Start connecting to the peer.
+    //! \return 0 if connected, EINPROGRESS if the connection is pending,
+    //! else the errno of the failure.
+    //-------------------------------------------------------------------------
+    int connect(const SocketAddress& p_address)
+    {
+        if (::connect(m_fd,
+                      reinterpret_cast<const sockaddr*>(&p_address.storage),
+                      p_address.length) == 0)
+        {
+            return 0;
+        }
+        return errno;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Wait until the socket is writable.
+    //! \param p_timeout_ms Maximum wait in milliseconds (0: do not wait).
+    //! \return true if the socket is writable or has a pending error.
+    //-------------------------------------------------------------------------
+    bool waitWritable(int p_timeout_ms) const
+    {
+#if defined(MYLOGGER_HAS_EPOLL)
+        epoll_event event{};
+        int ready;
+        do
+        {
+            ready = ::epoll_wait(m_epoll_fd, &event, 1, p_timeout_ms);
+        } while ((ready < 0) && (errno == EINTR));
+        return ready > 0;
+#else
+        pollfd descriptor{ m_fd, POLLOUT, 0 };
+        int ready;
+        do
+        {
+            ready = ::poll(&descriptor, 1, p_timeout_ms);
+        } while ((ready < 0) && (errno == EINTR));
+        return ready > 0;
+#endif
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check without blocking whether a pending connection completed.
+    //! \return 0 if connected, EINPROGRESS if still pending, else the errno
+    //! of the failure.
+    //-------------------------------------------------------------------------
+    int pollConnected() const
+    {
+        if (!waitWritable(0))
+        {
+            return EINPROGRESS;
+        }
+
+        int error = 0;
+        socklen_t length = sizeof(error);
+        ::getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        return error;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Send bytes without blocking and without raising SIGPIPE.
+    //! \return The number of bytes sent, or -1 with errno set.
+    //-------------------------------------------------------------------------
+    ssize_t send(const char* p_data, size_t p_size, int p_flags = 0) const
+    {
+#if defined(MSG_NOSIGNAL)
+        p_flags |= MSG_NOSIGNAL;
+#endif
+        ssize_t sent;
+        do
+        {
+            sent = ::send(m_fd, p_data, p_size, p_flags);
+        } while ((sent < 0) && (errno == EINTR));
+        return sent;
+    }
+
+#if defined(MYLOGGER_HAS_ZEROCOPY)
+    //-------------------------------------------------------------------------
+    //! \brief Read the MSG_ZEROCOPY completion notifications from the error
+    //! queue.
+    //! \param p_completed In/out: number of zero-copy sends completed so far
+    //! (notifications carry ranges of send identifiers).
+    //-------------------------------------------------------------------------
+    void reapZeroCopy(uint32_t& p_completed) const
+    {
+        char control[128];
+        for (;;)
+        {
+            msghdr message{};
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            if (::recvmsg(m_fd, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+            {
+                return;
+            }
+
+            for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr;
+                 header = CMSG_NXTHDR(&message, header))
+            {
+                auto* error =
+                    reinterpret_cast<sock_extended_err*>(CMSG_DATA(header));
+                if (error->ee_origin == SO_EE_ORIGIN_ZEROCOPY)
+                {
+                    p_completed = std::max(p_completed, error->ee_data + 1u);
+                }
+            }
+        }
+    }
+#endif
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the socket descriptor (-1 if closed).
+    //-------------------------------------------------------------------------
+    int fd() const
+    {
+        return m_fd;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the socket is open.
+    //-------------------------------------------------------------------------
+    bool isOpen() const
+    {
+        return m_fd >= 0;
+    }
+
+private:
+
+    //! \brief The socket descriptor
+    int m_fd = -1;
+#if defined(MYLOGGER_HAS_EPOLL)
+    //! \brief The epoll instance watching the socket
+    int m_epoll_fd = -1;
+#endif
+};
+
+// *****************************************************************************
+//! \brief Bounded spool of framed records sent on a non-blocking stream
+//! socket (TCP or Unix stream).
+//!
+//! Records are framed with FrameEncoder into the outgoing buffer. When a send
+//! is due, the outgoing buffer is sealed as a batch and swapped with the
+//! sending buffer, which is then written until the socket would block; new
+//! records keep going to the outgoing buffer meanwhile. Once the socket
+//! blocked, further sends wait for it to be reported writable.
+//!
+//! The connection is established without blocking and, when the peer is
+//! unreachable, retried with an exponential backoff. A peer given by its host
+//! name is resolved again on each attempt, so that a collector whose name
+//! cannot be resolved at startup (or whose address changed) is eventually
+//! reached; note that getaddrinfo() may block on a DNS query, at most once
+//! per backoff delay. Records that do not fit in the spool are dropped and
+//! counted. When the connection breaks in the middle of a frame, the rest of
+//! this frame is discarded so that the next connection starts on a frame
+//! boundary, and its records are counted as dropped.
+//!
+//! On Linux, large sends can use MSG_ZEROCOPY: the sending buffer is then
+//! kept alive until the kernel notifies that it no longer reads it.
+// *****************************************************************************
+class StreamSpool
+{
+    using Clock = std::chrono::steady_clock;
+
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor. Starts connecting to the peer.
+    //! \param p_address The address of the peer.
+    //! \param p_config Batching, spool, socket and reconnection tuning.
+    //-------------------------------------------------------------------------
+    StreamSpool(const SocketAddress& p_address,
+                const SocketWriterConfig& p_config)
+        : m_address(p_address),
+          m_config(p_config),
+          m_backoff(p_config.initial_backoff)
+    {
+        m_outgoing.reserve(m_config.batch_size * 2u);
+        m_sending.reserve(m_config.batch_size * 2u);
+        m_last_send = Clock::now();
+        connect(m_last_send);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor. Starts connecting to the peer, whose host name is
+    //! resolved on each connection attempt.
+    //! \param p_host The host name or numeric address of the peer.
+    //! \param p_port The port of the peer.
+    //! \param p_config Batching, spool, socket and reconnection tuning.
+    //-------------------------------------------------------------------------
+    StreamSpool(const std::string& p_host,
+                unsigned short p_port,
+                const SocketWriterConfig& p_config)
+        : m_host(p_host),
+          m_port(p_port),
+          m_config(p_config),
+          m_backoff(p_config.initial_backoff)
+    {
+        m_outgoing.reserve(m_config.batch_size * 2u);
+        m_sending.reserve(m_config.batch_size * 2u);
+        m_last_send = Clock::now();
+        connect(m_last_send);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Destructor. Waits up to the shutdown timeout for the pending
+    //! records to be sent.
+    //-------------------------------------------------------------------------
+    ~StreamSpool()
+    {
+        const auto deadline = Clock::now() + m_config.shutdown_timeout;
+        for (;;)
+        {
+            auto now = Clock::now();
+            pump(now);
+            if ((pendingBytes() == 0u) || (m_state == State::Disconnected) ||
+                (now >= deadline))
+            {
+                break;
+            }
+            auto remaining = std::chrono::duration_cast<
+                std::chrono::milliseconds>(deadline - now);
+            m_socket.waitWritable(static_cast<int>(remaining.count()) + 1);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Spool a record and send the spool when the batch is full or
+    //! when the oldest record waited too long.
+    //! \param p_severity The severity of the record.
+    //! \param p_payload The formatted record.
+    //-------------------------------------------------------------------------
+    void push(uint8_t p_severity, const std::string& p_payload)
+    {
+        if (!reserveSpool(2u * FrameEncoder::HEADER_SIZE + p_payload.size()))
+        {
+            return;
+        }
+        if (m_config.batch_frames && (m_batch_offset == NO_BATCH))
+        {
+            m_batch_offset = FrameEncoder::openBatch(m_outgoing);
+        }
+        FrameEncoder::appendRecord(m_outgoing, p_severity, p_payload);
+
+        if (pendingBytes() >= m_config.batch_size)
+        {
+            pump(Clock::now());
+        }
+        else
+        {
+            auto now = Clock::now();
+            if (now - m_last_send >= m_config.max_latency)
+            {
+                pump(now);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Try to send the whole spool without blocking.
+    //-------------------------------------------------------------------------
+    void flush()
+    {
+        pump(Clock::now());
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the socket is connected to the peer.
+    //-------------------------------------------------------------------------
+    bool isConnected() const
+    {
+        return m_state == State::Connected;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of bytes waiting in the spool (including the
+    //! frame headers).
+    //-------------------------------------------------------------------------
+    size_t pendingBytes() const
+    {
+        return m_sending.size() - m_sent_offset + m_outgoing.size();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of records dropped because the spool was full
+    //! or because the connection broke while their frame was sent.
+    //-------------------------------------------------------------------------
+    uint64_t getDroppedRecords() const
+    {
+        return m_dropped_records;
+    }
+
+private:
+
+    //! \brief Connection state machine.
+    enum class State
+    {
+        Disconnected, //!< Waiting for the backoff delay to elapse
+        Connecting,   //!< Non-blocking connection in progress
+        Connected     //!< Ready to send
+    };
+
+    //! \brief No batch frame is open in the spool.
+    static constexpr size_t NO_BATCH = static_cast<size_t>(-1);
+
+    //-------------------------------------------------------------------------
+    //! \brief Check that the spool can hold p_size more bytes, else count a
+    //! dropped record.
+    //-------------------------------------------------------------------------
+    bool reserveSpool(size_t p_size)
+    {
+        if (pendingBytes() + p_size > m_config.max_spool_size)
+        {
+            ++m_dropped_records;
+            return false;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Advance the connection state machine and send what the socket
+    //! accepts without blocking.
+    //-------------------------------------------------------------------------
+    void pump(Clock::time_point p_now)
+    {
+        m_last_send = p_now;
+
+        if (m_state == State::Disconnected)
+        {
+            if (p_now < m_next_attempt)
+            {
+                return;
+            }
+            connect(p_now);
+        }
+
+        if (m_state == State::Connecting)
+        {
+            int status = m_socket.pollConnected();
+            if (status == 0)
+            {
+                onConnected();
+            }
+            else if ((status != EINPROGRESS) ||
+                     (p_now - m_connect_start >= m_config.connect_timeout))
+            {
+                disconnect(p_now);
+                return;
+            }
+            else
+            {
+                return;
+            }
+        }
+
+        // Do not retry a send before the socket drained some data.
+        if (m_blocked && !m_socket.waitWritable(0))
+        {
+            return;
+        }
+
+        send(p_now);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Start a non-blocking connection to the peer.
+    //-------------------------------------------------------------------------
+    void connect(Clock::time_point p_now)
+    {
+        if (!m_host.empty())
+        {
+            m_address = SocketAddress::fromHost(m_host, m_port, SOCK_STREAM);
+        }
+        if (!m_address.isValid() ||
+            !m_socket.open(m_address.family(), SOCK_STREAM))
+        {
+            disconnect(p_now);
+            return;
+        }
+        applyOptions();
+
+        int status = m_socket.connect(m_address);
+        if (status == 0)
+        {
+            onConnected();
+        }
+        else if (status == EINPROGRESS)
+        {
+            m_state = State::Connecting;
+            m_connect_start = p_now;
+        }
+        else
+        {
+            disconnect(p_now);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Apply the socket tuning of the configuration.
+    //-------------------------------------------------------------------------
+    void applyOptions()
+    {
+        const bool is_tcp = (m_address.family() == AF_INET) ||
+                            (m_address.family() == AF_INET6);
+        if (is_tcp && m_config.tcp_nodelay)
+        {
+            m_socket.setOption(IPPROTO_TCP, TCP_NODELAY, 1);
+        }
+        if (m_config.send_buffer_size > 0)
+        {
+            m_socket.setOption(
+                SOL_SOCKET, SO_SNDBUF, m_config.send_buffer_size);
+        }
+#if defined(MYLOGGER_HAS_ZEROCOPY)
+        m_zerocopy = is_tcp && (m_config.zerocopy_threshold > 0u) &&
+                     m_socket.setOption(SOL_SOCKET, SO_ZEROCOPY, 1);
+        m_zerocopy_sent = 0u;
+        m_zerocopy_completed = 0u;
+#endif
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief The connection is established: reset the backoff delay.
+    //-------------------------------------------------------------------------
+    void onConnected()
+    {
+        m_state = State::Connected;
+        m_blocked = false;
+        m_backoff = m_config.initial_backoff;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Close the socket, drop the partially sent frame (counting its
+    //! records as dropped) and schedule the next connection attempt.
+    //-------------------------------------------------------------------------
+    void disconnect(Clock::time_point p_now)
+    {
+        m_socket.close();
+        m_state = State::Disconnected;
+        m_next_attempt = p_now + m_backoff;
+        m_backoff = std::min(m_backoff * 2, m_config.max_backoff);
+
+        if (m_sent_offset > m_frame_offset)
+        {
+            // The records of the discarded frame (all those of a batch) are
+            // lost for the peer.
+            const size_t size = frameSize(m_frame_offset);
+            FrameDecoder::decode(m_sending.data() + m_frame_offset,
+                                 size,
+                                 [this](uint8_t, const char*, size_t)
+                                 { ++m_dropped_records; });
+            m_frame_offset += size;
+            m_sent_offset = m_frame_offset;
+        }
+
+#if defined(MYLOGGER_HAS_ZEROCOPY)
+        // Notifications of a closed socket can no longer be read.
+        for (auto& buffer : m_zerocopy_inflight)
+        {
+            recycle(std::move(buffer.data));
+        }
+        m_zerocopy_inflight.clear();
+        if (m_sending_zerocopy)
+        {
+            // The remaining frames must not be written in a buffer the
+            // kernel may still read: move them to a fresh buffer.
+            std::string rest = takeBuffer();
+            rest.assign(m_sending, m_sent_offset, std::string::npos);
+            m_sending.swap(rest);
+            recycle(std::move(rest));
+            m_sent_offset = m_frame_offset = 0u;
+            m_sending_zerocopy = false;
+        }
+#endif
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Send the spool until the socket would block.
+    //-------------------------------------------------------------------------
+    void send(Clock::time_point p_now)
+    {
+#if defined(MYLOGGER_HAS_ZEROCOPY)
+        releaseZeroCopyBuffers();
+#endif
+        m_blocked = false;
+        for (;;)
+        {
+            if (m_sent_offset == m_sending.size())
+            {
+                if (!nextSendingBuffer())
+                {
+                    return;
+                }
+            }
+
+            const size_t size = m_sending.size() - m_sent_offset;
+            int flags = 0;
+#if defined(MYLOGGER_HAS_ZEROCOPY)
+            if (m_zerocopy && (size >= m_config.zerocopy_threshold))
+            {
+                flags = MSG_ZEROCOPY;
+            }
+#endif
+            ssize_t sent =
+                m_socket.send(m_sending.data() + m_sent_offset, size, flags);
+            if (sent < 0)
+            {
+                if ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+                    (errno == ENOBUFS))
+                {
+                    m_blocked = true;
+                }
+                else
+                {
+                    disconnect(p_now);
+                }
+                return;
+            }
+
+#if defined(MYLOGGER_HAS_ZEROCOPY)
+            if (flags != 0)
+            {
+                ++m_zerocopy_sent;
+                m_sending_zerocopy = true;
+            }
+#endif
+            m_sent_offset += static_cast<size_t>(sent);
+
+            // Track the start of the frame being sent.
+            while ((m_frame_offset < m_sent_offset) &&
+                   (m_frame_offset + frameSize(m_frame_offset) <=
+                    m_sent_offset))
+            {
+                m_frame_offset += frameSize(m_frame_offset);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief The sending buffer has been sent: seal the outgoing records and
+    //! make them the sending buffer.
+    //! \return false if there is nothing left to send.
+    //-------------------------------------------------------------------------
+    bool nextSendingBuffer()
+    {
+#if defined(MYLOGGER_HAS_ZEROCOPY)
+        if (m_sending_zerocopy)
+        {
+            // The kernel may still read it: keep it until notified.
+            m_zerocopy_inflight.push_back(
+                { std::move(m_sending), m_zerocopy_sent });
+            m_sending = takeBuffer();
+            m_sending_zerocopy = false;
+        }
+#endif
+        m_sending.clear();
+        m_sent_offset = 0u;
+        m_frame_offset = 0u;
+
+        if (m_outgoing.empty())
+        {
+            return false;
+        }
+
+        // The records spooled so far form the batch: seal it.
+        if (m_batch_offset != NO_BATCH)
+        {
+            FrameEncoder::closeBatch(m_outgoing, m_batch_offset);
+            m_batch_offset = NO_BATCH;
+        }
+        m_sending.swap(m_outgoing);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the size of the frame starting at the given offset of the
+    //! sending buffer.
+    //-------------------------------------------------------------------------
+    size_t frameSize(size_t p_offset) const
+    {
+        return FrameEncoder::HEADER_SIZE +
+               FrameDecoder::readBigEndian32(m_sending.data() + p_offset);
+    }
+
+#if defined(MYLOGGER_HAS_ZEROCOPY)
+    //-------------------------------------------------------------------------
+    //! \brief Recycle the buffers the kernel notified it no longer reads.
+    //-------------------------------------------------------------------------
+    void releaseZeroCopyBuffers()
+    {
+        if (m_zerocopy_inflight.empty())
+        {
+            return;
+        }
+
+        m_socket.reapZeroCopy(m_zerocopy_completed);
+        while (!m_zerocopy_inflight.empty() &&
+               (m_zerocopy_inflight.front().last_send <=
+                m_zerocopy_completed))
+        {
+            recycle(std::move(m_zerocopy_inflight.front().data));
+            m_zerocopy_inflight.pop_front();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get an empty buffer, reusing a recycled one if any.
+    //-------------------------------------------------------------------------
+    std::string takeBuffer()
+    {
+        if (m_free_buffers.empty())
+        {
+            std::string buffer;
+            buffer.reserve(m_config.batch_size * 2u);
+            return buffer;
+        }
+        std::string buffer = std::move(m_free_buffers.back());
+        m_free_buffers.pop_back();
+        return buffer;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Give back a buffer for later reuse.
+    //-------------------------------------------------------------------------
+    void recycle(std::string&& p_buffer)
+    {
+        p_buffer.clear();
+        m_free_buffers.push_back(std::move(p_buffer));
+    }
+#endif
+
+    //! \brief Host name of the peer (empty if given by its address)
+    std::string m_host;
+    //! \brief Port of the peer (with m_host)
+    unsigned short m_port = 0u;
+    //! \brief Address of the peer
+    SocketAddress m_address;
+    //! \brief Batching, spool, socket and reconnection tuning
+    SocketWriterConfig m_config;
+    //! \brief Connection status
+    State m_state = State::Disconnected;
+    //! \brief The last send would have blocked
+    bool m_blocked = false;
+    //! \brief Current reconnection delay
+    std::chrono::milliseconds m_backoff;
+    //! \brief Earliest time of the next connection attempt
+    Clock::time_point m_next_attempt{};
+    //! \brief Start time of the pending connection
+    Clock::time_point m_connect_start{};
+    //! \brief Time of the last send attempt
+    Clock::time_point m_last_send{};
+    //! \brief Frames spooled since the last swap
+    std::string m_outgoing;
+    //! \brief Offset of the open batch frame in the outgoing buffer
+    size_t m_batch_offset = NO_BATCH;
+    //! \brief Frames being sent
+    std::string m_sending;
+    //! \brief Number of bytes of the sending buffer already sent
+    size_t m_sent_offset = 0u;
+    //! \brief Offset of the first frame not completely sent
+    size_t m_frame_offset = 0u;
+    //! \brief Number of records dropped (spool full or broken connection)
+    uint64_t m_dropped_records = 0u;
+#if defined(MYLOGGER_HAS_ZEROCOPY)
+    //! \brief Buffer still read by the kernel after a zero-copy send.
+    struct InflightBuffer
+    {
+        //! \brief The sent bytes
+        std::string data;
+        //! \brief Number of zero-copy sends once this buffer was sent
+        uint32_t last_send;
+    };
+
+    //! \brief MSG_ZEROCOPY is enabled on the socket
+    bool m_zerocopy = false;
+    //! \brief The sending buffer was partly sent with MSG_ZEROCOPY
+    bool m_sending_zerocopy = false;
+    //! \brief Number of zero-copy sends on the socket
+    uint32_t m_zerocopy_sent = 0u;
+    //! \brief Number of zero-copy sends the kernel completed
+    uint32_t m_zerocopy_completed = 0u;
+    //! \brief Buffers waiting for their completion notification
+    std::deque<InflightBuffer> m_zerocopy_inflight;
+    //! \brief Buffers ready for reuse
+    std::vector<std::string> m_free_buffers;
+#endif
+    //! \brief The socket. Declared after the buffers a zero-copy send may
+    //! still reference, so that it is closed before they are freed.
+    PosixSocket m_socket;
+};
+
+// *****************************************************************************
+//! \brief Packer of framed records into datagrams (UDP or Unix datagram).
+//!
+//! Records are framed with FrameEncoder and packed into a datagram until the
+//! configured MTU is reached, the oldest record waited too long or a flush
+//! is requested. Datagram sinks are fire-and-forget: a datagram the socket
+//! cannot accept immediately is dropped and its records are counted.
+// *****************************************************************************
+class DatagramSpool
+{
+    using Clock = std::chrono::steady_clock;
+
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_address The address of the peer.
+    //! \param p_config Packing tuning.
+    //-------------------------------------------------------------------------
+    DatagramSpool(const SocketAddress& p_address,
+                  const DatagramWriterConfig& p_config)
+        : m_address(p_address), m_config(p_config)
+    {
+        m_datagram.reserve(m_config.mtu);
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Destructor. Sends the pending datagram.
+    //-------------------------------------------------------------------------
+    ~DatagramSpool()
+    {
+        sendDatagram();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Pack a record into the pending datagram.
+    //! \param p_severity The severity of the record.
+    //! \param p_payload The formatted record.
+    //-------------------------------------------------------------------------
+    void push(uint8_t p_severity, const std::string& p_payload)
+    {
+        const size_t frame_size = FrameEncoder::HEADER_SIZE + p_payload.size();
+        if (frame_size > m_config.mtu)
+        {
+            ++m_dropped_records;
+            return;
+        }
+        if (m_datagram.size() + frame_size > m_config.mtu)
+        {
+            sendDatagram();
+        }
+
+        auto now = Clock::now();
+        if (m_datagram.empty())
+        {
+            m_first_record = now;
+        }
+        FrameEncoder::appendRecord(m_datagram, p_severity, p_payload);
+        ++m_datagram_records;
+
+        if (now - m_first_record >= m_config.max_latency)
+        {
+            sendDatagram();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Send the pending datagram.
+    //-------------------------------------------------------------------------
+    void flush()
+    {
+        sendDatagram();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of records dropped (too large, or datagram not
+    //! accepted by the socket).
+    //-------------------------------------------------------------------------
+    uint64_t getDroppedRecords() const
+    {
+        return m_dropped_records;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of datagrams sent.
+    //-------------------------------------------------------------------------
+    uint64_t getDatagramCount() const
+    {
+        return m_datagram_count;
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Send the pending datagram, (re)connecting the socket if needed.
+    //-------------------------------------------------------------------------
+    void sendDatagram()
+    {
+        if (m_datagram.empty())
+        {
+            return;
+        }
+
+        if (!m_socket.isOpen() && m_address.isValid() &&
+            m_socket.open(m_address.family(), SOCK_DGRAM) &&
+            (m_socket.connect(m_address) != 0))
+        {
+            m_socket.close();
+        }
+
+        if (m_socket.isOpen() &&
+            (m_socket.send(m_datagram.data(), m_datagram.size()) >= 0))
+        {
+            ++m_datagram_count;
+        }
+        else
+        {
+            // A Unix peer that went away needs a new connect().
+            if (m_socket.isOpen() && (errno != EAGAIN) &&
+                (errno != EWOULDBLOCK) && (errno != ECONNREFUSED))
+            {
+                m_socket.close();
+            }
+            m_dropped_records += m_datagram_records;
+        }
+
+        m_datagram.clear();
+        m_datagram_records = 0u;
+    }
+
+    //! \brief The socket
+    PosixSocket m_socket;
+    //! \brief Address of the peer
+    SocketAddress m_address;
+    //! \brief Packing tuning
+    DatagramWriterConfig m_config;
+    //! \brief The pending datagram
+    std::string m_datagram;
+    //! \brief Number of records in the pending datagram
+    uint64_t m_datagram_records = 0u;
+    //! \brief Time the first record of the pending datagram was packed
+    Clock::time_point m_first_record{};
+    //! \brief Number of dropped records
+    uint64_t m_dropped_records = 0u;
+    //! \brief Number of datagrams sent
+    uint64_t m_datagram_count = 0u;
+};
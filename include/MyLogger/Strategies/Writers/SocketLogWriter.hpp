@@ -1,12 +1,24 @@
 #pragma once
 
 #include "MyLogger/Strategies/LogWriter.hpp"
-#include <SFML/Network.hpp>
+#include "MyLogger/Strategies/Writers/PosixSocket.hpp"
+
+#include <cstdint>
 #include <string>
 
 // *****************************************************************************
 //! \brief Thread-safe template-based TCP writer for logging.
-//! Direct SFML implementation without PIMPL pattern.
+//! Records are appended to a bounded spool and sent in batches on a
+//! non-blocking POSIX socket (see StreamSpool): a slow or dead collector
+//! never blocks the logging threads. When the collector is unreachable,
+//! reconnections are attempted with an exponential backoff (resolving the
+//! host name again on each attempt) and records exceeding the spool capacity
+//! are dropped and counted.
+//!
+//! Records are sent as length-prefixed frames (see FrameEncoder) holding the
+//! middle part of the line formatter. The begin and end parts, as well as
+//! the file header and footer, only glue records into a file document and
+//! are not sent.
 //! \tparam LineFormatterType The type of the line formatter.
 // *****************************************************************************
 template <typename LineFormatterType>
@@ -20,88 +32,75 @@ public:
     //! \param p_host The host to connect to.
     //! \param p_port The port to connect to.
     //! \param p_line_formatter Reference to the line formatter.
+    //! \param p_config Batching, spool, socket and reconnection tuning.
     //-------------------------------------------------------------------------
     SocketLogWriter(const std::string& p_host,
                     unsigned short p_port,
-                    LineFormatterType& p_line_formatter)
+                    LineFormatterType& p_line_formatter,
+                    const SocketWriterConfig& p_config = SocketWriterConfig())
         : LogWriter<SocketLogWriter<LineFormatterType>, LineFormatterType>(
               p_line_formatter),
-          m_host(p_host),
-          m_port(p_port)
+          m_spool(p_host, p_port, p_config)
     {
-        connect();
     }
 
     //-------------------------------------------------------------------------
-    //! \brief Destructor.
+    //! \brief File header and footer have no meaning in a framed stream: they
+    //! are ignored. Called under lock by base class.
     //-------------------------------------------------------------------------
-    ~SocketLogWriter() = default;
+    void writeImpl(const std::string& /*p_message*/)
+    {
+    }
 
     //-------------------------------------------------------------------------
-    //! \brief Write a complete formatted message.
-    //! Called under lock by base class.
-    //! \param p_message The message to write.
+    //! \brief Spool a record. Called under lock by base class.
     //-------------------------------------------------------------------------
-    void writeImpl(const std::string& p_message)
+    void writeRecordImpl(LogLevel p_level,
+                         const std::string& /*p_begin*/,
+                         const std::string& p_middle,
+                         const std::string& /*p_end*/)
     {
-        ensureConnected();
-        if (m_connected)
-        {
-            std::string message = p_message + "\n";
-            send(message.c_str(), message.size());
-        }
+        m_spool.push(static_cast<uint8_t>(p_level), p_middle);
+        this->reportDroppedRecords(m_spool.getDroppedRecords());
     }
 
     //-------------------------------------------------------------------------
-    //! \brief Flush the socket output.
+    //! \brief Try to send the whole spool without blocking.
     //! Called under lock by base class.
     //-------------------------------------------------------------------------
     void flushImpl()
     {
-        // For sockets, no need for an explicit flush
+        m_spool.flush();
+        this->reportDroppedRecords(m_spool.getDroppedRecords());
     }
 
-private:
-
     //-------------------------------------------------------------------------
-    //! \brief Establish socket connection.
+    //! \brief Check if the socket is connected to the collector.
     //-------------------------------------------------------------------------
-    void connect()
+    bool isConnected() const
     {
-        m_connected =
-            m_socket.connect(m_host, m_port) == sf::Socket::Status::Done;
+        return m_spool.isConnected();
     }
 
     //-------------------------------------------------------------------------
-    //! \brief Ensure the socket connection is established.
+    //! \brief Get the number of bytes waiting in the spool (including the
+    //! frame headers).
     //-------------------------------------------------------------------------
-    void ensureConnected()
+    size_t pendingBytes() const
     {
-        if (!m_connected)
-        {
-            connect();
-        }
+        return m_spool.pendingBytes();
     }
 
     //-------------------------------------------------------------------------
-    //! \brief Send data through the socket.
-    //! \param p_data The data to send.
-    //! \param p_size The size of the data.
+    //! \brief Get the number of records dropped because the spool was full.
     //-------------------------------------------------------------------------
-    void send(const char* p_data, size_t p_size)
+    uint64_t getDroppedRecords() const
     {
-        if (m_connected)
-        {
-            m_socket.send(p_data, p_size);
-        }
+        return m_spool.getDroppedRecords();
     }
 
-    //! \brief SFML TCP socket
-    sf::TcpSocket m_socket;
-    //! \brief Host to connect to
-    std::string m_host;
-    //! \brief Port to connect to
-    unsigned short m_port;
-    //! \brief Connection status
-    bool m_connected = false;
-};
\ No newline at end of file
+private:
+
+    //! \brief Spool of frames sent to the collector
+    StreamSpool m_spool;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+// *****************************************************************************
+//! \brief Tuning of the stream socket writers (TCP, Unix stream).
+// *****************************************************************************
+struct SocketWriterConfig
+{
+    //! \brief Pending bytes triggering a send.
+    size_t batch_size = 16u * 1024u;
+    //! \brief Maximum pending bytes. Records beyond this limit are dropped.
+    size_t max_spool_size = 4u * 1024u * 1024u;
+    //! \brief Maximum time a record waits in the spool before a send is tried.
+    std::chrono::milliseconds max_latency{ 100 };
+    //! \brief Delay before the first reconnection attempt.
+    std::chrono::milliseconds initial_backoff{ 100 };
+    //! \brief Upper bound of the exponential reconnection delay.
+    std::chrono::milliseconds max_backoff{ 30000 };
+    //! \brief Time given to a non-blocking connection to complete.
+    std::chrono::milliseconds connect_timeout{ 1000 };
+    //! \brief Group the records of a send into a single batch frame.
+    bool batch_frames = true;
+    //! \brief Time the destructor waits for the spool to drain.
+    std::chrono::milliseconds shutdown_timeout{ 500 };
+    //! \brief Disable Nagle's algorithm (TCP only): records are already
+    //! batched by the writer.
+    bool tcp_nodelay = true;
+    //! \brief Kernel send buffer size (SO_SNDBUF). 0 keeps the system default.
+    int send_buffer_size = 0;
+    //! \brief Sends of at least this size use MSG_ZEROCOPY (Linux only). 0
+    //! disables zero-copy. Only worth it for batches of tens of kilobytes.
+    size_t zerocopy_threshold = 0u;
+};
+
+// *****************************************************************************
+//! \brief Tuning of the datagram socket writers.
+// *****************************************************************************
+struct DatagramWriterConfig
+{
+    //! \brief Maximum size of a datagram. Records are packed into a datagram
+    //! until this size is reached; a record larger than it is dropped.
+    size_t mtu = 1400u;
+    //! \brief Maximum time a record waits before its datagram is sent.
+    std::chrono::milliseconds max_latency{ 100 };
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "MyLogger/Strategies/LogWriter.hpp"
+#include "MyLogger/Strategies/Writers/PosixSocket.hpp"
+
+#include <string>
+
+// *****************************************************************************
+//! \brief Thread-safe template-based fire-and-forget UDP writer for logging.
+//! Records are framed (see FrameEncoder) and packed into datagrams up to the
+//! configured MTU. Nothing is retransmitted: datagrams the socket cannot
+//! accept are dropped and counted. As for SocketLogWriter, only the middle
+//! part of the line formatter is sent.
+//! \tparam LineFormatterType The type of the line formatter.
+// *****************************************************************************
+template <typename LineFormatterType>
+class UdpLogWriter
+    : public LogWriter<UdpLogWriter<LineFormatterType>, LineFormatterType>
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor.
+    //! \param p_host The host to send to.
+    //! \param p_port The port to send to.
+    //! \param p_line_formatter Reference to the line formatter.
+    //! \param p_config Datagram packing tuning.
+    //-------------------------------------------------------------------------
+    UdpLogWriter(const std::string& p_host,
+                 unsigned short p_port,
+                 LineFormatterType& p_line_formatter,
+                 const DatagramWriterConfig& p_config = DatagramWriterConfig())
+        : LogWriter<UdpLogWriter<LineFormatterType>, LineFormatterType>(
+              p_line_formatter),
+          m_spool(SocketAddress::fromHost(p_host, p_port, SOCK_DGRAM),
+                  p_config)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief File header and footer are not sent. Called under lock by base
+    //! class.
+    //-------------------------------------------------------------------------
+    void writeImpl(const std::string& /*p_message*/)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Pack a record into the pending datagram.
+    //! Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void writeRecordImpl(LogLevel p_level,
+                         const std::string& /*p_begin*/,
+                         const std::string& p_middle,
+                         const std::string& /*p_end*/)
+    {
+        m_spool.push(static_cast<uint8_t>(p_level), p_middle);
+        this->reportDroppedRecords(m_spool.getDroppedRecords());
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Send the pending datagram.
+    //! Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void flushImpl()
+    {
+        m_spool.flush();
+        this->reportDroppedRecords(m_spool.getDroppedRecords());
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of dropped records.
+    //-------------------------------------------------------------------------
+    uint64_t getDroppedRecords() const
+    {
+        return m_spool.getDroppedRecords();
+    }
+
+private:
+
+    //! \brief Packs records into datagrams
+    DatagramSpool m_spool;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "MyLogger/Strategies/LogWriter.hpp"
+#include "MyLogger/Strategies/Writers/PosixSocket.hpp"
+
+#include <memory>
+#include <string>
+
+// *****************************************************************************
+//! \brief Thread-safe template-based Unix domain socket writer for logging,
+//! for collectors running on the same host.
+//! - Stream mode (SocketWriterConfig): same behavior as SocketLogWriter,
+//!   framed records batched on a non-blocking connection with reconnection
+//!   backoff and a bounded spool.
+//! - Datagram mode (DatagramWriterConfig): framed records packed into
+//!   datagrams up to the configured size, dropped if the collector is not
+//!   there.
+//! Only the middle part of the line formatter is sent.
+//! \tparam LineFormatterType The type of the line formatter.
+// *****************************************************************************
+template <typename LineFormatterType>
+class UnixSocketLogWriter
+    : public LogWriter<UnixSocketLogWriter<LineFormatterType>,
+                       LineFormatterType>
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor for a stream socket.
+    //! \param p_path The path of the collector socket.
+    //! \param p_line_formatter Reference to the line formatter.
+    //! \param p_config Batching, spool and reconnection tuning.
+    //-------------------------------------------------------------------------
+    UnixSocketLogWriter(const std::string& p_path,
+                        LineFormatterType& p_line_formatter,
+                        const SocketWriterConfig& p_config = SocketWriterConfig())
+        : LogWriter<UnixSocketLogWriter<LineFormatterType>, LineFormatterType>(
+              p_line_formatter),
+          m_stream(std::make_unique<StreamSpool>(
+              SocketAddress::fromUnixPath(p_path), p_config))
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Constructor for a datagram socket.
+    //! \param p_path The path of the collector socket.
+    //! \param p_line_formatter Reference to the line formatter.
+    //! \param p_config Datagram packing tuning.
+    //-------------------------------------------------------------------------
+    UnixSocketLogWriter(const std::string& p_path,
+                        LineFormatterType& p_line_formatter,
+                        const DatagramWriterConfig& p_config)
+        : LogWriter<UnixSocketLogWriter<LineFormatterType>, LineFormatterType>(
+              p_line_formatter),
+          m_datagram(std::make_unique<DatagramSpool>(
+              SocketAddress::fromUnixPath(p_path), p_config))
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief File header and footer are not sent. Called under lock by base
+    //! class.
+    //-------------------------------------------------------------------------
+    void writeImpl(const std::string& /*p_message*/)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Spool a record. Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void writeRecordImpl(LogLevel p_level,
+                         const std::string& /*p_begin*/,
+                         const std::string& p_middle,
+                         const std::string& /*p_end*/)
+    {
+        if (m_stream)
+        {
+            m_stream->push(static_cast<uint8_t>(p_level), p_middle);
+        }
+        else
+        {
+            m_datagram->push(static_cast<uint8_t>(p_level), p_middle);
+        }
+        this->reportDroppedRecords(getDroppedRecords());
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Send the pending records without blocking.
+    //! Called under lock by base class.
+    //-------------------------------------------------------------------------
+    void flushImpl()
+    {
+        if (m_stream)
+        {
+            m_stream->flush();
+        }
+        else
+        {
+            m_datagram->flush();
+        }
+        this->reportDroppedRecords(getDroppedRecords());
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the number of dropped records.
+    //-------------------------------------------------------------------------
+    uint64_t getDroppedRecords() const
+    {
+        return m_stream ? m_stream->getDroppedRecords()
+                        : m_datagram->getDroppedRecords();
+    }
+
+private:
+
+    //! \brief Spool of the stream mode
+    std::unique_ptr<StreamSpool> m_stream;
+    //! \brief Packer of the datagram mode
+    std::unique_ptr<DatagramSpool> m_datagram;
+};
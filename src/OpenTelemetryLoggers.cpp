@@ -0,0 +1,28 @@
+#include "MyLogger/OpenTelemetryLoggers.hpp"
+
+// Instantiations declared extern by MyLogger/OpenTelemetryLoggers.hpp: the
+// only translation unit compiling them.
+template class LogLineFormatter<OpenTelemetryLineFormatter>;
+template class LogFileFormatter<OpenTelemetryFileFormatter,
+                                OpenTelemetryLineFormatter>;
+
+template class LogWriter<FileLogWriter<OpenTelemetryLineFormatter>,
+                         OpenTelemetryLineFormatter>;
+template class FileLogWriter<OpenTelemetryLineFormatter>;
+template class Logger<FileLogWriter<OpenTelemetryLineFormatter>,
+                      OpenTelemetryFileFormatter,
+                      OpenTelemetryLineFormatter>;
+
+template class LogWriter<ConsoleLogWriter<OpenTelemetryLineFormatter>,
+                         OpenTelemetryLineFormatter>;
+template class ConsoleLogWriter<OpenTelemetryLineFormatter>;
+template class Logger<ConsoleLogWriter<OpenTelemetryLineFormatter>,
+                      OpenTelemetryFileFormatter,
+                      OpenTelemetryLineFormatter>;
+
+template class LogWriter<SocketLogWriter<OpenTelemetryLineFormatter>,
+                         OpenTelemetryLineFormatter>;
+template class SocketLogWriter<OpenTelemetryLineFormatter>;
+template class Logger<SocketLogWriter<OpenTelemetryLineFormatter>,
+                      OpenTelemetryFileFormatter,
+                      OpenTelemetryLineFormatter>;
@@ -0,0 +1,96 @@
+#include "MyLogger/Strategies/Formatters/Binary/BinaryFileFormatter.hpp"
+#include "MyLogger/Strategies/Formatters/Binary/BinaryLogConverter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+//! \brief Encode spans as a binary log (header then one record per span) and
+//! convert it into JSON.
+//-----------------------------------------------------------------------------
+std::string toJson(std::initializer_list<const Trace*> p_spans)
+{
+    BinaryLineFormatter line_formatter("test", "1.0");
+    BinaryFileFormatter file_formatter(line_formatter, "unused",
+                                       FileMode::Create);
+    std::string log = file_formatter.header();
+    for (const Trace* span : p_spans)
+    {
+        log += line_formatter.formatBegin(LogLevel::INFO) +
+               line_formatter.formatSpan(*span) + line_formatter.formatEnd();
+    }
+
+    std::string json;
+    EXPECT_EQ(BinaryLogConverter::toJson(log.data(), log.size(), json), "");
+    return json;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+TEST(BinaryEncoder, IdsRoundTrip)
+{
+    const std::string ids[] = { "", "00000000", "0123456789abcdef",
+                                "0123456789ABCDEF", "abc", "not-an-id" };
+    std::string encoded;
+    for (const auto& id : ids)
+    {
+        BinaryEncoder::putId(encoded, id);
+    }
+
+    BinaryDecoder decoder(encoded.data(), encoded.size());
+    for (const auto& id : ids)
+    {
+        std::string decoded;
+        ASSERT_TRUE(decoder.id(decoded));
+        EXPECT_EQ(decoded, id);
+    }
+    EXPECT_TRUE(decoder.atEnd());
+
+    // Generated IDs are stored as raw bytes.
+    encoded.clear();
+    BinaryEncoder::putId(encoded, "0123456789abcdef");
+    EXPECT_EQ(encoded.size(), 1u + 8u);
+}
+
+//-----------------------------------------------------------------------------
+TEST(BinaryLogConverter, SpansLinkToTheirParent)
+{
+    Trace root("request");
+    auto child = root.createChildSpan("query");
+    child->end();
+    root.end();
+
+    const std::string json = toJson({ &root, child.get() });
+    EXPECT_NE(json.find("\"spanID\":\"" + child->getSpanId() +
+                        "\",\"traceID\":\"" + root.getTraceId() +
+                        "\",\"parentSpanID\":\"" + root.getSpanId() + "\""),
+              std::string::npos);
+    EXPECT_EQ(json.find("\"parentSpanID\":\"" + child->getSpanId()),
+              std::string::npos);
+}
+
+//-----------------------------------------------------------------------------
+TEST(BinaryLogConverter, SpansWithoutIdAreNotLinked)
+{
+    // Spans created while their trace is not sampled have no span ID.
+    Trace root("request");
+    root.setSampled(false);
+    Trace child(root, "query");
+    Trace grandchild(child, "fetch");
+    EXPECT_TRUE(child.getSpanId().empty());
+    grandchild.end();
+    child.end();
+
+    const std::string json = toJson({ &child, &grandchild });
+    EXPECT_NE(json.find("\"spanID\":\"\",\"traceID\":\"" + root.getTraceId() +
+                        "\",\"parentSpanID\":\"" + root.getSpanId() + "\""),
+              std::string::npos);
+    EXPECT_NE(json.find("\"spanID\":\"\",\"operationName\":\"fetch\""),
+              std::string::npos);
+    EXPECT_EQ(json.find("0000000000000000"), std::string::npos);
+}
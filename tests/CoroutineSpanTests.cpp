@@ -0,0 +1,147 @@
+#include "MyLogger/Strategies/CoroutineSpan.hpp"
+
+// CoroutineSpan only exists in C++20 builds.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#    include <gtest/gtest.h>
+
+#    include <coroutine>
+
+namespace
+{
+
+// *****************************************************************************
+//! \brief Eagerly started coroutine, destroyed by its owner.
+// *****************************************************************************
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object()
+        {
+            return Task{
+                std::coroutine_handle<promise_type>::from_promise(*this)
+            };
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception()
+        {
+        }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> p_handle)
+        : handle(p_handle)
+    {
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+        handle.destroy();
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// *****************************************************************************
+//! \brief Awaitable suspending the coroutine until the test resumes it.
+// *****************************************************************************
+struct Pause
+{
+    bool await_ready() const
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> p_handle)
+    {
+        *resumer = p_handle;
+    }
+
+    void await_resume()
+    {
+    }
+
+    std::coroutine_handle<>* resumer;
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Coroutine awaiting a ready awaitable then a Pause, and recording
+//! the active span after each await.
+//-----------------------------------------------------------------------------
+Task run(std::coroutine_handle<>* p_resumer, Trace** p_after_ready,
+         Trace** p_after_pause)
+{
+    CoroutineSpan span("handle");
+    co_await span.wrap(std::suspend_never{});
+    *p_after_ready = TraceContext::current();
+    co_await span.wrap(Pause{ p_resumer });
+    *p_after_pause = TraceContext::current();
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+TEST(CoroutineSpan, ReadyAwaitsKeepTheSpanOfTheThread)
+{
+    Trace request("request");
+    TraceContext::Scope scope(request);
+    {
+        std::coroutine_handle<> resumer;
+        Trace* after_ready = nullptr;
+        Trace* after_pause = nullptr;
+        Task task = run(&resumer, &after_ready, &after_pause);
+
+        // Not suspended by the ready await, suspended by the pause.
+        ASSERT_EQ(request.getChildren().size(), 1u);
+        Trace* span = request.getChildren().begin()->get();
+        EXPECT_EQ(after_ready, span);
+        EXPECT_EQ(TraceContext::current(), &request);
+
+        // Resumed under another span: the coroutine gets its span back, then
+        // gives the thread its span back when it ends.
+        Trace worker("worker");
+        {
+            TraceContext::Scope worker_scope(worker);
+            resumer.resume();
+            EXPECT_EQ(after_pause, span);
+            EXPECT_EQ(TraceContext::current(), &worker);
+        }
+    }
+    EXPECT_EQ(TraceContext::current(), &request);
+}
+
+//-----------------------------------------------------------------------------
+TEST(CoroutineSpan, CompletedWithoutSuspendingRestoresTheSpanOfTheThread)
+{
+    Trace request("request");
+    TraceContext::Scope scope(request);
+    {
+        Task task = []() -> Task
+        {
+            CoroutineSpan span("handle");
+            co_await span.wrap(std::suspend_never{});
+            co_await span.wrap(std::suspend_never{});
+        }();
+        EXPECT_TRUE(task.handle.done());
+    }
+    EXPECT_EQ(TraceContext::current(), &request);
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include "MyLogger/Strategies/Formatters/MsgPack/MsgPackLineFormatter.hpp"
+#include "MyLogger/Strategies/Writers/CrashHandler.hpp"
+#include "MyLogger/Strategies/Writers/FileLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/MultiSinkLogWriter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+// *****************************************************************************
+//! \brief File formatter with a text header and footer.
+// *****************************************************************************
+class TextFileFormatter
+    : public LogFileFormatter<TextFileFormatter, MsgPackLineFormatter>
+{
+public:
+
+    TextFileFormatter(MsgPackLineFormatter& p_formatter,
+                      const std::string& p_filename)
+        : LogFileFormatter<TextFileFormatter, MsgPackLineFormatter>(
+              p_formatter, p_filename, FileMode::Create)
+    {
+    }
+
+    std::string headerImpl() const
+    {
+        return "header\n";
+    }
+
+    std::string footerImpl() const
+    {
+        return "footer\n";
+    }
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+TEST(CrashHandlerDeathTest, InstallIsIdempotent)
+{
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_EXIT(
+        {
+            CrashHandler::install({ SIGTERM });
+            CrashHandler::install({ SIGTERM });
+            ::raise(SIGTERM);
+        },
+        ::testing::KilledBySignal(SIGTERM),
+        "");
+}
+
+//-----------------------------------------------------------------------------
+TEST(CrashHandlerDeathTest, SignalDrainsRegions)
+{
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    const std::string path = "mylogger-crash-handler-test.log";
+    std::remove(path.c_str());
+
+    EXPECT_EXIT(
+        {
+            static const char records[] = "record 1\nrecord 2\n";
+            static CrashHandler::Region region;
+            region.fd = ::open(path.c_str(),
+                               O_WRONLY | O_CREAT | O_TRUNC,
+                               0644);
+            region.data = records;
+            region.size = sizeof(records) - 1u;
+            region.footer = "footer\n";
+            region.has_footer = true;
+            CrashHandler::registerRegion(region);
+            CrashHandler::install({ SIGABRT });
+            CrashHandler::install({ SIGABRT });
+            ::raise(SIGABRT);
+        },
+        ::testing::KilledBySignal(SIGABRT),
+        "");
+
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(content.str(), "record 1\nrecord 2\nfooter\n");
+    std::remove(path.c_str());
+}
+
+//-----------------------------------------------------------------------------
+TEST(CrashHandlerDeathTest, FileSinksOfAMultiSinkWriteTheirFooter)
+{
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    const std::string path = "mylogger-crash-handler-sink-test.log";
+    std::remove(path.c_str());
+
+    EXPECT_EXIT(
+        {
+            using MultiSink = MultiSinkLogWriter<MsgPackLineFormatter>;
+
+            MsgPackLineFormatter line_formatter("test", "1.0");
+            TextFileFormatter file_formatter(line_formatter, path);
+            auto writer = std::make_unique<MultiSink>(line_formatter);
+            writer->addSink(
+                std::make_unique<FileLogWriter<MsgPackLineFormatter>>(
+                    file_formatter));
+            writer->writeHeader(file_formatter);
+            writer->writeLine(LogLevel::INFO, std::string("record\n"));
+            writer->flush();
+            CrashHandler::install({ SIGABRT });
+            ::raise(SIGABRT);
+        },
+        ::testing::KilledBySignal(SIGABRT),
+        "");
+
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(content.str(), "header\nrecord\nfooter\n");
+    std::remove(path.c_str());
+}
@@ -0,0 +1,76 @@
+#include "MyLogger/Strategies/Formatters/MsgPack/MsgPackLineFormatter.hpp"
+#include "MyLogger/Strategies/Writers/FileLogWriter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+//! \brief Log file shared by the tests.
+const char* TEST_FILE = "mylogger-file-writer-test.log";
+
+//-----------------------------------------------------------------------------
+//! \brief Append p_count records larger than the writer buffer, each made
+//! of a begin, middle and end part holding the character p_id.
+//-----------------------------------------------------------------------------
+void appendLargeRecords(char p_id, size_t p_count)
+{
+    MsgPackLineFormatter formatter("test", "1.0");
+    FileLogWriter<MsgPackLineFormatter> writer(
+        TEST_FILE, formatter, FileMode::Append, 64u);
+    const std::string begin(100u, p_id);
+    const std::string middle(1024u, p_id);
+    const std::string end = std::string(100u, p_id) + "\n";
+    for (size_t i = 0u; i < p_count; ++i)
+    {
+        writer.writeRecordImpl(LogLevel::INFO, begin, middle, end);
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+TEST(FileLogWriter, LargeRecordsAreAppendedWhole)
+{
+    static constexpr size_t PROCESSES = 8u;
+    static constexpr size_t RECORDS = 2000u;
+    std::remove(TEST_FILE);
+
+    pid_t children[PROCESSES];
+    for (size_t i = 0u; i < PROCESSES; ++i)
+    {
+        children[i] = ::fork();
+        ASSERT_GE(children[i], 0);
+        if (children[i] == 0)
+        {
+            appendLargeRecords(static_cast<char>('a' + i), RECORDS);
+            ::_exit(0);
+        }
+    }
+    for (pid_t child : children)
+    {
+        int status = 0;
+        ASSERT_EQ(::waitpid(child, &status, 0), child);
+        ASSERT_TRUE(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+    }
+
+    // Every line is a single record: one character repeated, full length.
+    std::ifstream file(TEST_FILE);
+    std::string line;
+    size_t lines = 0u;
+    while (std::getline(file, line))
+    {
+        ++lines;
+        ASSERT_EQ(line.size(), 200u + 1024u);
+        EXPECT_EQ(line.find_first_not_of(line[0]), std::string::npos);
+    }
+    EXPECT_EQ(lines, PROCESSES * RECORDS);
+    std::remove(TEST_FILE);
+}
@@ -0,0 +1,32 @@
+#include "MyLogger/Strategies/Formatters/MsgPack/MsgPackLineFormatter.hpp"
+#include "MyLogger/Strategies/Writers/GzipFileLogWriter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+//-----------------------------------------------------------------------------
+TEST(GzipFileLogWriter, UnwritableFramesAreDropped)
+{
+    MsgPackLineFormatter formatter("test", "1.0");
+    GzipFileLogWriter<MsgPackLineFormatter> writer(
+        "/nonexistent-directory/mylogger-test.gz",
+        formatter,
+        FileMode::Create,
+        64u);
+    ASSERT_FALSE(writer.isOpen());
+
+    // Each record fills a frame, which is discarded instead of kept.
+    const std::string middle(100u, 'x');
+    for (size_t i = 0u; i < 10u; ++i)
+    {
+        writer.writeRecordImpl(LogLevel::INFO, "", middle, "\n");
+        EXPECT_EQ(writer.getDroppedRecords(), i + 1u);
+    }
+
+    // The pending records of a flushed frame are dropped as well.
+    writer.writeRecordImpl(LogLevel::INFO, "", "short", "\n");
+    writer.flushImpl();
+    EXPECT_EQ(writer.getDroppedRecords(), 11u);
+    EXPECT_EQ(writer.getFrameCount(), 0u);
+}
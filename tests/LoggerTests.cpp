@@ -0,0 +1,214 @@
+#include "MyLogger/MyLogger.hpp"
+#include "MyLogger/Strategies/Formatters/MsgPack/MsgPackFileFormatter.hpp"
+#include "MyLogger/Strategies/Writers/MultiSinkLogWriter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// *****************************************************************************
+//! \brief Writer keeping the level of the records written.
+// *****************************************************************************
+class CaptureLogWriter
+    : public LogWriter<CaptureLogWriter, MsgPackLineFormatter>
+{
+public:
+
+    explicit CaptureLogWriter(MsgPackLineFormatter& p_line_formatter)
+        : LogWriter<CaptureLogWriter, MsgPackLineFormatter>(p_line_formatter)
+    {
+    }
+
+    void writeImpl(const std::string& /*p_message*/)
+    {
+    }
+
+    void writeRecordImpl(LogLevel p_level,
+                         const std::string& /*p_begin*/,
+                         const std::string& /*p_middle*/,
+                         const std::string& /*p_end*/)
+    {
+        levels.push_back(p_level);
+    }
+
+    void flushImpl()
+    {
+    }
+
+    //! \brief Levels of the records written
+    std::vector<LogLevel> levels;
+};
+
+using CaptureLogger =
+    Logger<CaptureLogWriter, MsgPackFileFormatter, MsgPackLineFormatter>;
+
+//-----------------------------------------------------------------------------
+//! \brief Create a logger writing into a CaptureLogWriter.
+//-----------------------------------------------------------------------------
+std::unique_ptr<CaptureLogger> makeLogger()
+{
+    auto line_formatter =
+        std::make_unique<MsgPackLineFormatter>("test", "1.0");
+    auto file_formatter = std::make_unique<MsgPackFileFormatter>(
+        *line_formatter, "unused", FileMode::Create);
+    auto writer = std::make_unique<CaptureLogWriter>(*line_formatter);
+    return std::make_unique<CaptureLogger>(std::move(writer),
+                                           std::move(line_formatter),
+                                           std::move(file_formatter));
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+TEST(Logger, TailSamplerFiltersSpans)
+{
+    auto logger = makeLogger();
+    logger->setTailSampler(
+        TailSampler(LogLevel::ERROR, std::chrono::hours(1)));
+
+    Trace span("query");
+    span.end();
+    logger->logSpan(LogLevel::INFO, span);
+    logger->logSpan(LogLevel::ERROR, span);
+
+    ASSERT_EQ(logger->getWriter().levels.size(), 1u);
+    EXPECT_EQ(logger->getWriter().levels[0], LogLevel::ERROR);
+    EXPECT_EQ(logger->getSampledOutTraces(), 1u);
+}
+
+//-----------------------------------------------------------------------------
+TEST(Logger, RateLimiterLimitsSpans)
+{
+    auto logger = makeLogger();
+    RateLimiterConfig config;
+    config.rate = 0.001;
+    config.burst = 2.0;
+    config.summary_interval = std::chrono::hours(1);
+    logger->setRateLimiter(config);
+
+    Trace span("query");
+    span.end();
+    for (int i = 0; i < 5; ++i)
+    {
+        logger->logSpan(LogLevel::INFO, span);
+    }
+
+    EXPECT_EQ(logger->getWriter().levels.size(), 2u);
+    EXPECT_EQ(logger->getRateLimitedTraces(), 3u);
+}
+
+//-----------------------------------------------------------------------------
+TEST(Logger, StreamedSpansGoThroughTheSamePathAsTraces)
+{
+    auto logger = makeLogger();
+    logger->setTailSampler(
+        TailSampler(LogLevel::WARNING, std::chrono::hours(1)));
+
+    Trace root("request");
+    root.setSpanExporter(logger->spanExporter(LogLevel::INFO));
+    {
+        auto child = root.createChildSpan("query");
+        child->end();
+    }
+    root.end();
+
+    Trace trace("request");
+    trace.end();
+    logger->log(LogLevel::INFO, trace);
+
+    EXPECT_TRUE(logger->getWriter().levels.empty());
+    EXPECT_EQ(logger->getSampledOutTraces(), 3u);
+}
+
+//-----------------------------------------------------------------------------
+TEST(Logger, HeadSamplerDecidesTracesNotSampledAtCreation)
+{
+    auto logger = makeLogger();
+    logger->setHeadSampler(HeadSampler(0.0));
+
+    Trace trace("request");
+    trace.end();
+    logger->log(LogLevel::INFO, trace);
+    Trace span("query");
+    span.end();
+    logger->logSpan(LogLevel::INFO, span);
+    EXPECT_TRUE(logger->getWriter().levels.empty());
+    EXPECT_EQ(logger->getSampledOutTraces(), 1u);
+
+    // A decision stored on the trace prevails.
+    trace.setSampled(true);
+    logger->log(LogLevel::INFO, trace);
+    EXPECT_EQ(logger->getWriter().levels.size(), 1u);
+}
+
+//-----------------------------------------------------------------------------
+TEST(Logger, LazyAttributesRunOnTheLoggingThread)
+{
+    using MultiSink = MultiSinkLogWriter<MsgPackLineFormatter>;
+
+    auto line_formatter =
+        std::make_unique<MsgPackLineFormatter>("test", "1.0");
+    auto file_formatter = std::make_unique<MsgPackFileFormatter>(
+        *line_formatter, "unused", FileMode::Create);
+    auto writer = std::make_unique<MultiSink>(*line_formatter);
+    writer->addSink(std::make_unique<CaptureLogWriter>(*line_formatter));
+    Logger<MultiSink, MsgPackFileFormatter, MsgPackLineFormatter> logger(
+        std::move(writer),
+        std::move(line_formatter),
+        std::move(file_formatter));
+
+    std::thread::id computed_on;
+    int calls = 0;
+    Trace trace("request");
+    trace.addAttribute("body",
+                       [&computed_on, &calls]()
+                       {
+                           computed_on = std::this_thread::get_id();
+                           ++calls;
+                           return std::string("payload");
+                       });
+    trace.end();
+    logger.log(LogLevel::INFO, trace);
+    logger.log(LogLevel::INFO, trace);
+    logger.flush();
+
+    EXPECT_EQ(computed_on, std::this_thread::get_id());
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(trace.getAttributes().at("body"), "payload");
+}
+
+//-----------------------------------------------------------------------------
+TEST(Logger, LazyAttributesAreComputedOnceAcrossLoggers)
+{
+    auto first = makeLogger();
+    auto second = makeLogger();
+
+    std::atomic<int> calls{ 0 };
+    for (int i = 0; i < 100; ++i)
+    {
+        Trace trace("request");
+        auto child = trace.createChildSpan("query");
+        child->addAttribute("body",
+                            [&calls]()
+                            {
+                                ++calls;
+                                return std::string("payload");
+                            });
+        child->end();
+        trace.end();
+
+        std::thread other([&]() { second->log(LogLevel::INFO, trace); });
+        first->log(LogLevel::INFO, trace);
+        other.join();
+        EXPECT_EQ(child->getAttributes().at("body"), "payload");
+    }
+    EXPECT_EQ(calls, 100);
+}
@@ -0,0 +1,496 @@
+#include "MyLogger/Strategies/Formatters/MsgPack/MsgPackLineFormatter.hpp"
+#include "MyLogger/Strategies/Writers/FrameProtocol.hpp"
+#include "MyLogger/Strategies/Writers/SocketLogWriter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The records are decoded by a MessagePack reader independent of the
+// encoder, covering the types MsgPackLineFormatter writes.
+namespace
+{
+
+//! \brief MessagePack value decoded from the wire.
+struct Value
+{
+    enum class Type
+    {
+        Nil,
+        Bool,
+        Uint,
+        Int,
+        Double,
+        String,
+        Timestamp,
+        Array,
+        Map
+    };
+
+    Type type = Type::Nil;
+    //! \brief Value of booleans, integers and timestamps (in nanoseconds)
+    uint64_t integer = 0u;
+    double real = 0.0;
+    std::string string;
+    std::vector<Value> array;
+    std::map<std::string, Value> map;
+
+    //-------------------------------------------------------------------------
+    //! \brief Get the value of a map key, throwing if missing.
+    //-------------------------------------------------------------------------
+    const Value& operator[](const std::string& p_key) const
+    {
+        auto it = map.find(p_key);
+        if (it == map.end())
+        {
+            throw std::runtime_error("missing key " + p_key);
+        }
+        return it->second;
+    }
+};
+
+// *****************************************************************************
+//! \brief Reader of MessagePack values from a buffer.
+// *****************************************************************************
+class MsgPackReader
+{
+public:
+
+    MsgPackReader(const char* p_data, size_t p_size)
+        : m_cursor(reinterpret_cast<const uint8_t*>(p_data)),
+          m_end(m_cursor + p_size)
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Check if the whole buffer was read.
+    //-------------------------------------------------------------------------
+    bool atEnd() const
+    {
+        return m_cursor == m_end;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read the next value.
+    //-------------------------------------------------------------------------
+    Value read()
+    {
+        const uint8_t tag = byte();
+        if (tag <= 0x7Fu)
+        {
+            return integer(Value::Type::Uint, tag);
+        }
+        if ((tag & 0xF0u) == 0x80u)
+        {
+            return map(tag & 0x0Fu);
+        }
+        if ((tag & 0xF0u) == 0x90u)
+        {
+            return array(tag & 0x0Fu);
+        }
+        if ((tag & 0xE0u) == 0xA0u)
+        {
+            return string(tag & 0x1Fu);
+        }
+        if (tag >= 0xE0u)
+        {
+            return integer(Value::Type::Int,
+                           static_cast<uint64_t>(static_cast<int8_t>(tag)));
+        }
+        switch (tag)
+        {
+            case 0xC0u:
+                return Value();
+            case 0xC2u:
+            case 0xC3u:
+                return integer(Value::Type::Bool, tag & 1u);
+            case 0xCBu:
+            {
+                const uint64_t bits = bigEndian(8u);
+                Value value;
+                value.type = Value::Type::Double;
+                std::memcpy(&value.real, &bits, sizeof(bits));
+                return value;
+            }
+            case 0xCCu:
+            case 0xCDu:
+            case 0xCEu:
+            case 0xCFu:
+                return integer(Value::Type::Uint,
+                               bigEndian(1u << (tag - 0xCCu)));
+            case 0xD0u:
+            case 0xD1u:
+            case 0xD2u:
+            case 0xD3u:
+                return signedInteger(1u << (tag - 0xD0u));
+            case 0xD6u:
+                return timestamp(4u);
+            case 0xD7u:
+                return timestamp(8u);
+            case 0xC7u:
+                return timestamp(bigEndian(1u));
+            case 0xD9u:
+                return string(bigEndian(1u));
+            case 0xDAu:
+                return string(bigEndian(2u));
+            case 0xDBu:
+                return string(bigEndian(4u));
+            case 0xDCu:
+                return array(bigEndian(2u));
+            case 0xDDu:
+                return array(bigEndian(4u));
+            case 0xDEu:
+                return map(bigEndian(2u));
+            case 0xDFu:
+                return map(bigEndian(4u));
+            default:
+                throw std::runtime_error("unexpected MessagePack type " +
+                                         std::to_string(tag));
+        }
+    }
+
+private:
+
+    uint8_t byte()
+    {
+        if (m_cursor == m_end)
+        {
+            throw std::runtime_error("truncated MessagePack value");
+        }
+        return *m_cursor++;
+    }
+
+    uint64_t bigEndian(size_t p_size)
+    {
+        uint64_t value = 0u;
+        for (size_t i = 0u; i < p_size; ++i)
+        {
+            value = (value << 8u) | byte();
+        }
+        return value;
+    }
+
+    static Value integer(Value::Type p_type, uint64_t p_value)
+    {
+        Value value;
+        value.type = p_type;
+        value.integer = p_value;
+        return value;
+    }
+
+    Value signedInteger(size_t p_size)
+    {
+        const uint64_t bits = bigEndian(p_size);
+        const unsigned shift = static_cast<unsigned>(64u - 8u * p_size);
+        return integer(Value::Type::Int,
+                       static_cast<uint64_t>(
+                           static_cast<int64_t>(bits << shift) >> shift));
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Read a timestamp extension (type -1) of p_size bytes.
+    //-------------------------------------------------------------------------
+    Value timestamp(uint64_t p_size)
+    {
+        if (static_cast<int8_t>(byte()) != -1)
+        {
+            throw std::runtime_error("unexpected extension type");
+        }
+        uint64_t nanos;
+        switch (p_size)
+        {
+            case 4u:
+                nanos = bigEndian(4u) * 1000000000u;
+                break;
+            case 8u:
+            {
+                const uint64_t bits = bigEndian(8u);
+                nanos = (bits & 0x3FFFFFFFFu) * 1000000000u + (bits >> 34u);
+                break;
+            }
+            case 12u:
+            {
+                const uint64_t fraction = bigEndian(4u);
+                nanos = bigEndian(8u) * 1000000000u + fraction;
+                break;
+            }
+            default:
+                throw std::runtime_error("unexpected timestamp size");
+        }
+        return integer(Value::Type::Timestamp, nanos);
+    }
+
+    Value string(uint64_t p_size)
+    {
+        if (p_size > static_cast<uint64_t>(m_end - m_cursor))
+        {
+            throw std::runtime_error("string overruns the buffer");
+        }
+        Value value;
+        value.type = Value::Type::String;
+        value.string.assign(reinterpret_cast<const char*>(m_cursor),
+                            static_cast<size_t>(p_size));
+        m_cursor += p_size;
+        return value;
+    }
+
+    Value array(uint64_t p_size)
+    {
+        Value value;
+        value.type = Value::Type::Array;
+        for (uint64_t i = 0u; i < p_size; ++i)
+        {
+            value.array.push_back(read());
+        }
+        return value;
+    }
+
+    Value map(uint64_t p_size)
+    {
+        Value value;
+        value.type = Value::Type::Map;
+        for (uint64_t i = 0u; i < p_size; ++i)
+        {
+            Value key = read();
+            if (key.type != Value::Type::String)
+            {
+                throw std::runtime_error("map key is not a string");
+            }
+            value.map[key.string] = read();
+        }
+        if (value.map.size() != p_size)
+        {
+            throw std::runtime_error("duplicated map key");
+        }
+        return value;
+    }
+
+    const uint8_t* m_cursor;
+    const uint8_t* m_end;
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Decode a buffer holding exactly one MessagePack value.
+//-----------------------------------------------------------------------------
+Value decodeOne(const std::string& p_buffer)
+{
+    MsgPackReader reader(p_buffer.data(), p_buffer.size());
+    Value value = reader.read();
+    if (!reader.atEnd())
+    {
+        throw std::runtime_error("bytes left after the value");
+    }
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Check a decoded record against the trace it was encoded from.
+//-----------------------------------------------------------------------------
+void expectRecord(const Value& p_record,
+                  const Trace& p_trace,
+                  size_t p_spans)
+{
+    ASSERT_EQ(p_record.type, Value::Type::Map);
+    EXPECT_EQ(p_record.map.size(), 6u);
+    EXPECT_EQ(p_record["traceID"].string, p_trace.getTraceId());
+    EXPECT_EQ(p_record["traceName"].string, p_trace.getOperationName());
+    EXPECT_EQ(p_record["startTime"].type, Value::Type::Timestamp);
+    EXPECT_EQ(p_record["startTime"].integer, p_trace.getStartTimeNanos());
+    EXPECT_EQ(p_record["total_duration"].integer, p_trace.getDurationNanos());
+    EXPECT_EQ(p_record["total_spans"].integer, p_spans);
+    ASSERT_EQ(p_record["spans"].array.size(), p_spans);
+    EXPECT_EQ(p_record["spans"].array[0]["spanID"].string,
+              p_trace.getSpanId());
+}
+
+// *****************************************************************************
+//! \brief Local TCP server storing everything a client sends until it
+//! disconnects.
+// *****************************************************************************
+class CaptureServer
+{
+public:
+
+    CaptureServer()
+    {
+        m_listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        ::bind(m_listener, reinterpret_cast<sockaddr*>(&address), length);
+        ::listen(m_listener, 1);
+        ::getsockname(
+            m_listener, reinterpret_cast<sockaddr*>(&address), &length);
+        m_port = ntohs(address.sin_port);
+
+        m_thread = std::thread(
+            [this]()
+            {
+                int client = ::accept(m_listener, nullptr, nullptr);
+                if (client < 0)
+                {
+                    return;
+                }
+                char buffer[4096];
+                ssize_t size;
+                while ((size = ::read(client, buffer, sizeof(buffer))) > 0)
+                {
+                    m_received.append(buffer, static_cast<size_t>(size));
+                }
+                ::close(client);
+            });
+    }
+
+    ~CaptureServer()
+    {
+        ::shutdown(m_listener, SHUT_RDWR);
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        ::close(m_listener);
+    }
+
+    unsigned short port() const
+    {
+        return m_port;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Wait for the client to disconnect and get what it sent.
+    //-------------------------------------------------------------------------
+    const std::string& received()
+    {
+        m_thread.join();
+        return m_received;
+    }
+
+private:
+
+    //! \brief Listening socket
+    int m_listener;
+    //! \brief Port bound on the loopback
+    unsigned short m_port;
+    //! \brief Thread accepting one client and reading it
+    std::thread m_thread;
+    //! \brief Bytes received from the client
+    std::string m_received;
+};
+
+//! \brief Record frame read back from the stream.
+struct Frame
+{
+    uint8_t severity;
+    std::string body;
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Split a stream into its record frames, unpacking batch frames.
+//-----------------------------------------------------------------------------
+void readFrames(const std::string& p_stream, std::vector<Frame>& p_frames)
+{
+    size_t offset = 0u;
+    while (offset < p_stream.size())
+    {
+        if (p_stream.size() - offset < FrameEncoder::HEADER_SIZE)
+        {
+            throw std::runtime_error("truncated frame header");
+        }
+        const auto* header =
+            reinterpret_cast<const uint8_t*>(p_stream.data() + offset);
+        const size_t length = (size_t(header[0]) << 24u) |
+                              (size_t(header[1]) << 16u) |
+                              (size_t(header[2]) << 8u) | size_t(header[3]);
+        offset += FrameEncoder::HEADER_SIZE;
+        if (p_stream.size() - offset < length)
+        {
+            throw std::runtime_error("truncated frame body");
+        }
+        std::string body = p_stream.substr(offset, length);
+        offset += length;
+        if (header[4] == FrameEncoder::BATCH)
+        {
+            readFrames(body, p_frames);
+        }
+        else
+        {
+            p_frames.push_back(Frame{ header[5], std::move(body) });
+        }
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+TEST(MsgPackLineFormatter, RecordIsTheMiddlePart)
+{
+    MsgPackLineFormatter formatter("checkout", "1.2.3");
+    Trace trace("checkout", { { "http.method", "POST" } });
+    auto child = trace.createChildSpan("payment");
+    child->addEvent("authorized", { { "bank", "acme" } });
+    child->end();
+    trace.addTag("items", "3", "int");
+    trace.end();
+
+    EXPECT_TRUE(formatter.formatBegin(LogLevel::ERROR).empty());
+    EXPECT_TRUE(formatter.formatEnd().empty());
+
+    const Value record = decodeOne(formatter.formatMiddle(trace));
+    expectRecord(record, trace, 2u);
+    const Value& root = record["spans"].array[0];
+    EXPECT_EQ(root["attributes"]["http.method"].string, "POST");
+    EXPECT_EQ(root["tags"]["items"].type, Value::Type::Uint);
+    EXPECT_EQ(root["tags"]["items"].integer, 3u);
+    const Value& payment = record["spans"].array[1];
+    EXPECT_EQ(payment["parentSpanID"].string, trace.getSpanId());
+    EXPECT_EQ(payment["depth"].integer, 1u);
+    EXPECT_EQ(payment["events"].array[0]["name"].string, "authorized");
+    EXPECT_EQ(payment["events"].array[0]["attributes"]["bank"].string,
+              "acme");
+
+    const Value span = decodeOne(formatter.formatSpan(*child));
+    expectRecord(span, *child, 1u);
+}
+
+//-----------------------------------------------------------------------------
+TEST(MsgPackLineFormatter, SocketFramesDecode)
+{
+    MsgPackLineFormatter formatter("checkout", "1.2.3");
+    Trace trace("checkout");
+    auto child = trace.createChildSpan("payment");
+    child->end();
+    trace.end();
+
+    CaptureServer server;
+    {
+        SocketWriterConfig config;
+        config.shutdown_timeout = std::chrono::milliseconds(5000);
+        SocketLogWriter<MsgPackLineFormatter> writer(
+            "127.0.0.1", server.port(), formatter, config);
+        writer.writeLine(LogLevel::WARNING, trace);
+        writer.writeSpan(LogLevel::INFO, *child);
+    }
+
+    std::vector<Frame> frames;
+    readFrames(server.received(), frames);
+    ASSERT_EQ(frames.size(), 2u);
+
+    EXPECT_EQ(frames[0].severity, static_cast<uint8_t>(LogLevel::WARNING));
+    expectRecord(decodeOne(frames[0].body), trace, 2u);
+    EXPECT_EQ(frames[1].severity, static_cast<uint8_t>(LogLevel::INFO));
+    expectRecord(decodeOne(frames[1].body), *child, 1u);
+}
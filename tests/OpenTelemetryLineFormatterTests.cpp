@@ -0,0 +1,29 @@
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLineFormatter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+//-----------------------------------------------------------------------------
+TEST(OpenTelemetryLineFormatter, StringsAreEscaped)
+{
+    OpenTelemetryLineFormatter formatter("svc\"1", "1.0");
+    Trace trace("say \"hi\"");
+    trace.addAttribute("path", "C:\\logs\\app");
+    trace.addAttribute("multi\nline", std::string("a\tb\x01", 5u));
+    trace.addTag("quote", "\"", "str\"ing");
+    trace.addEvent("evt\r");
+    trace.end();
+
+    const std::string json = formatter.formatMiddle(trace);
+    EXPECT_NE(json.find("\"traceName\":\"say \\\"hi\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"serviceName\":\"svc\\\"1\""), std::string::npos);
+    EXPECT_NE(json.find("\"path\":\"C:\\\\logs\\\\app\""), std::string::npos);
+    EXPECT_NE(json.find("\"multi\\nline\":\"a\\tb\\u0001\\u0000\""),
+              std::string::npos);
+    EXPECT_NE(json.find("\"quote\":{\"value\":\"\\\"\","
+                        "\"type\":\"str\\\"ing\"}"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"evt\\r\""), std::string::npos);
+    EXPECT_EQ(json.find('\n'), std::string::npos);
+}
@@ -0,0 +1,284 @@
+#include "MyLogger/Strategies/Formatters/Otlp/OtlpLineFormatter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The records are decoded by a protobuf wire reader independent of the
+// encoder: every length has to match the bytes actually written and every
+// field is checked against the OTLP trace schema (opentelemetry-proto).
+namespace
+{
+
+//! \brief Protobuf field decoded from the wire.
+struct Field
+{
+    uint32_t number;
+    uint32_t wire_type;
+    //! \brief Value of varint and fixed64 fields
+    uint64_t integer;
+    //! \brief Payload of length-delimited fields
+    std::string bytes;
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Read a varint at p_cursor, throwing if it overruns p_end.
+//-----------------------------------------------------------------------------
+uint64_t readVarint(const char*& p_cursor, const char* p_end)
+{
+    uint64_t value = 0u;
+    for (unsigned shift = 0u; shift < 64u; shift += 7u)
+    {
+        if (p_cursor == p_end)
+        {
+            throw std::runtime_error("truncated varint");
+        }
+        const auto byte = static_cast<uint8_t>(*p_cursor++);
+        value |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+        if ((byte & 0x80u) == 0u)
+        {
+            return value;
+        }
+    }
+    throw std::runtime_error("varint too long");
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Decode the fields of a message, which shall use every byte.
+//-----------------------------------------------------------------------------
+std::vector<Field> decode(const std::string& p_message)
+{
+    std::vector<Field> fields;
+    const char* cursor = p_message.data();
+    const char* end = cursor + p_message.size();
+    while (cursor != end)
+    {
+        const uint64_t key = readVarint(cursor, end);
+        Field field{ static_cast<uint32_t>(key >> 3u),
+                     static_cast<uint32_t>(key & 7u), 0u, {} };
+        switch (field.wire_type)
+        {
+            case 0u:
+                field.integer = readVarint(cursor, end);
+                break;
+            case 1u:
+                if (end - cursor < 8)
+                {
+                    throw std::runtime_error("truncated fixed64");
+                }
+                for (unsigned i = 0u; i < 8u; ++i)
+                {
+                    field.integer |= static_cast<uint64_t>(
+                                         static_cast<uint8_t>(*cursor++))
+                                     << (8u * i);
+                }
+                break;
+            case 2u:
+            {
+                const uint64_t size = readVarint(cursor, end);
+                if (size > static_cast<uint64_t>(end - cursor))
+                {
+                    throw std::runtime_error("length overruns the message");
+                }
+                field.bytes.assign(cursor, static_cast<size_t>(size));
+                cursor += size;
+                break;
+            }
+            default:
+                throw std::runtime_error("unexpected wire type");
+        }
+        fields.push_back(std::move(field));
+    }
+    return fields;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Get the fields of a given number.
+//-----------------------------------------------------------------------------
+std::vector<Field> fieldsOf(const std::vector<Field>& p_fields,
+                            uint32_t p_number)
+{
+    std::vector<Field> found;
+    for (const auto& field : p_fields)
+    {
+        if (field.number == p_number)
+        {
+            found.push_back(field);
+        }
+    }
+    return found;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Get the single field of a given number.
+//-----------------------------------------------------------------------------
+Field fieldOf(const std::vector<Field>& p_fields, uint32_t p_number)
+{
+    const auto found = fieldsOf(p_fields, p_number);
+    if (found.size() != 1u)
+    {
+        throw std::runtime_error("field " + std::to_string(p_number) +
+                                 " found " + std::to_string(found.size()) +
+                                 " times");
+    }
+    return found.front();
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Convert a hexadecimal ID to the bytes written on the wire.
+//-----------------------------------------------------------------------------
+std::string toBytes(const std::string& p_hex)
+{
+    std::string bytes;
+    for (size_t i = 0u; i + 1u < p_hex.size(); i += 2u)
+    {
+        bytes.push_back(static_cast<char>(
+            std::stoul(p_hex.substr(i, 2u), nullptr, 16)));
+    }
+    return bytes;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Decode the string KeyValue attributes of a message.
+//-----------------------------------------------------------------------------
+std::map<std::string, std::string>
+attributesOf(const std::vector<Field>& p_fields, uint32_t p_number)
+{
+    std::map<std::string, std::string> attributes;
+    for (const auto& attribute : fieldsOf(p_fields, p_number))
+    {
+        const auto key_value = decode(attribute.bytes);
+        const auto value = decode(fieldOf(key_value, 2u).bytes);
+        attributes[fieldOf(key_value, 1u).bytes] = fieldOf(value, 1u).bytes;
+    }
+    return attributes;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Decode an ExportTraceServiceRequest, check its resource and scope,
+//! and return its spans.
+//-----------------------------------------------------------------------------
+std::vector<std::vector<Field>> decodeRequest(const std::string& p_request)
+{
+    const auto request = decode(p_request);
+    const auto resource_spans = decode(fieldOf(request, 1u).bytes);
+
+    const auto resource = decode(fieldOf(resource_spans, 1u).bytes);
+    const auto resource_attributes = attributesOf(resource, 1u);
+    EXPECT_EQ(resource_attributes.size(), 2u);
+    EXPECT_EQ(resource_attributes.at("service.name"), "checkout");
+    EXPECT_EQ(resource_attributes.at("service.version"), "1.2.3");
+
+    const auto scope_spans = decode(fieldOf(resource_spans, 2u).bytes);
+    const auto scope = decode(fieldOf(scope_spans, 1u).bytes);
+    EXPECT_EQ(fieldOf(scope, 1u).bytes, "MyLogger");
+
+    std::vector<std::vector<Field>> spans;
+    for (const auto& span : fieldsOf(scope_spans, 2u))
+    {
+        spans.push_back(decode(span.bytes));
+    }
+    return spans;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Check a decoded span against the trace it was encoded from.
+//-----------------------------------------------------------------------------
+void expectSpan(const std::vector<Field>& p_span, const Trace& p_trace)
+{
+    EXPECT_EQ(fieldOf(p_span, 1u).bytes, toBytes(p_trace.getTraceId()));
+    EXPECT_EQ(fieldOf(p_span, 1u).bytes.size(), 16u);
+    EXPECT_EQ(fieldOf(p_span, 2u).bytes, toBytes(p_trace.getSpanId()));
+    EXPECT_EQ(fieldOf(p_span, 2u).bytes.size(), 8u);
+    if (p_trace.getParentSpanId().empty())
+    {
+        EXPECT_TRUE(fieldsOf(p_span, 4u).empty());
+    }
+    else
+    {
+        EXPECT_EQ(fieldOf(p_span, 4u).bytes,
+                  toBytes(p_trace.getParentSpanId()));
+    }
+    EXPECT_EQ(fieldOf(p_span, 5u).bytes, p_trace.getOperationName());
+    EXPECT_EQ(fieldOf(p_span, 7u).wire_type, 1u);
+    EXPECT_EQ(fieldOf(p_span, 7u).integer, p_trace.getStartTimeNanos());
+    EXPECT_EQ(fieldOf(p_span, 8u).integer - fieldOf(p_span, 7u).integer,
+              p_trace.getDurationNanos());
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+TEST(OtlpLineFormatter, TraceRecordDecodes)
+{
+    OtlpLineFormatter formatter("checkout", "1.2.3");
+    Trace trace("checkout", { { "http.method", "POST" } });
+    auto child = trace.createChildSpan("payment", { { "amount", "42" } });
+    child->addEvent("authorized", { { "bank", "acme" } });
+    child->end();
+    trace.addTag("user", "alice", "string");
+    trace.end();
+
+    const std::string record = formatter.formatBegin(LogLevel::INFO) +
+                               formatter.formatMiddle(trace) +
+                               formatter.formatEnd();
+    ASSERT_TRUE(formatter.formatBegin(LogLevel::INFO).empty());
+    ASSERT_TRUE(formatter.formatEnd().empty());
+
+    // Length-delimited: the varint prefix is the size of the request.
+    const char* cursor = record.data();
+    const uint64_t size = readVarint(cursor, record.data() + record.size());
+    const std::string request(cursor, record.data() + record.size());
+    ASSERT_EQ(size, request.size());
+
+    const auto spans = decodeRequest(request);
+    ASSERT_EQ(spans.size(), 2u);
+
+    expectSpan(spans[0], trace);
+    const auto root_attributes = attributesOf(spans[0], 9u);
+    EXPECT_EQ(root_attributes.size(), 2u);
+    EXPECT_EQ(root_attributes.at("http.method"), "POST");
+    EXPECT_EQ(root_attributes.at("user"), "alice");
+    EXPECT_TRUE(fieldsOf(spans[0], 11u).empty());
+
+    expectSpan(spans[1], *child);
+    EXPECT_EQ(attributesOf(spans[1], 9u).at("amount"), "42");
+    const auto events = fieldsOf(spans[1], 11u);
+    ASSERT_EQ(events.size(), 1u);
+    const auto event = decode(events.front().bytes);
+    EXPECT_EQ(fieldOf(event, 1u).integer,
+              child->getEvents().front().timestamp_nanos);
+    EXPECT_EQ(fieldOf(event, 2u).bytes, "authorized");
+    EXPECT_EQ(attributesOf(event, 3u).at("bank"), "acme");
+}
+
+//-----------------------------------------------------------------------------
+TEST(OtlpLineFormatter, StreamedSpanDecodes)
+{
+    OtlpLineFormatter formatter("checkout", "1.2.3", false);
+    Trace trace("checkout");
+    auto child = trace.createChildSpan("payment");
+    child->end();
+
+    // Without prefix, the record is the request itself.
+    const auto spans = decodeRequest(formatter.formatSpan(*child));
+    ASSERT_EQ(spans.size(), 1u);
+    expectSpan(spans[0], *child);
+    EXPECT_TRUE(fieldsOf(spans[0], 9u).empty());
+}
+
+//-----------------------------------------------------------------------------
+TEST(OtlpLineFormatter, TruncatedRecordIsRejected)
+{
+    OtlpLineFormatter formatter("checkout", "1.2.3", false);
+    Trace trace("checkout");
+    trace.end();
+
+    std::string request = formatter.formatMiddle(trace);
+    request.pop_back();
+    EXPECT_THROW(decodeRequest(request), std::runtime_error);
+}
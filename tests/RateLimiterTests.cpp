@@ -0,0 +1,61 @@
+#include "MyLogger/Strategies/RateLimiter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+//! \brief Create a rate limiter allowing one trace per operation at once.
+//-----------------------------------------------------------------------------
+RateLimiter makeRateLimiter(size_t p_max_operations)
+{
+    RateLimiterConfig config;
+    config.rate = 1e-6;
+    config.burst = 1.0;
+    config.max_operations = p_max_operations;
+    return RateLimiter(config);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+TEST(RateLimiter, SummaryKeysDoNotCollide)
+{
+    RateLimiter limiter = makeRateLimiter(16u);
+    const auto now = RateLimiter::Clock::now();
+    for (int i = 0; i < 3; ++i)
+    {
+        limiter.tryAcquire("total", now);
+    }
+    limiter.tryAcquire("query", now);
+    limiter.tryAcquire("query", now);
+
+    Trace summary(RateLimiter::SUMMARY_NAME);
+    ASSERT_TRUE(limiter.summarize(summary, now));
+    const auto& attributes = summary.getAttributes();
+    EXPECT_EQ(attributes.size(), 3u);
+    EXPECT_EQ(attributes.at("operation.total"), "2");
+    EXPECT_EQ(attributes.at("operation.query"), "1");
+    EXPECT_EQ(attributes.at("total"), "3");
+}
+
+//-----------------------------------------------------------------------------
+TEST(RateLimiter, OperationsBeyondTheTableShareABucket)
+{
+    RateLimiter limiter = makeRateLimiter(1u);
+    const auto now = RateLimiter::Clock::now();
+    EXPECT_TRUE(limiter.tryAcquire("tracked", now));
+    EXPECT_TRUE(limiter.tryAcquire("first", now));
+    EXPECT_FALSE(limiter.tryAcquire("second", now));
+    EXPECT_FALSE(limiter.tryAcquire("tracked", now));
+
+    Trace summary(RateLimiter::SUMMARY_NAME);
+    ASSERT_TRUE(limiter.summarize(summary, now));
+    const auto& attributes = summary.getAttributes();
+    EXPECT_EQ(attributes.at("operation.<other>"), "1");
+    EXPECT_EQ(attributes.at("operation.tracked"), "1");
+    EXPECT_EQ(attributes.at("total"), "2");
+}
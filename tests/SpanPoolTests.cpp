@@ -0,0 +1,59 @@
+#include "MyLogger/Strategies/LogTrace.hpp"
+#include "MyLogger/Strategies/SpanPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+//! \brief Block size used by the tests only, so that spans do not share
+//! their cache.
+using Pool = SpanPool<40u>;
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+TEST(SpanPool, FreedBlocksAreReused)
+{
+    void* first = Pool::allocate();
+    Pool::deallocate(first);
+    EXPECT_EQ(Pool::allocate(), first);
+    Pool::deallocate(first);
+}
+
+//-----------------------------------------------------------------------------
+TEST(SpanPool, BlocksFreedByAnotherThreadAreCachedThere)
+{
+    void* block = Pool::allocate();
+    void* reused = nullptr;
+    std::thread other(
+        [block, &reused]()
+        {
+            Pool::deallocate(block);
+            reused = Pool::allocate();
+            Pool::deallocate(reused);
+        });
+    other.join();
+    EXPECT_EQ(reused, block);
+}
+
+//-----------------------------------------------------------------------------
+TEST(SpanPool, ChildSpansHaveUniqueHexIds)
+{
+    Trace root("request");
+    std::set<std::string> ids{ root.getSpanId() };
+    for (int i = 0; i < 1000; ++i)
+    {
+        auto child = root.createChildSpan("child");
+        ASSERT_EQ(child->getSpanId().size(), 16u);
+        EXPECT_EQ(child->getSpanId().find_first_not_of("0123456789abcdef"),
+                  std::string::npos);
+        EXPECT_TRUE(ids.insert(child->getSpanId()).second);
+    }
+    EXPECT_EQ(root.getTraceId().size(), 32u);
+    EXPECT_EQ(root.getChildren().size(), 1000u);
+}
@@ -0,0 +1,65 @@
+#include "MyLogger/Strategies/Writers/PosixSocket.hpp"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+
+//-----------------------------------------------------------------------------
+TEST(StreamSpool, RecordsOfABrokenFrameAreCounted)
+{
+    // Collector with a small receive buffer, never reading.
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    int receive_buffer = 4096;
+    ::setsockopt(listener,
+                 SOL_SOCKET,
+                 SO_RCVBUF,
+                 &receive_buffer,
+                 sizeof(receive_buffer));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&address), length),
+              0);
+    ASSERT_EQ(::listen(listener, 1), 0);
+    ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+
+    SocketWriterConfig config;
+    config.send_buffer_size = 4096;
+    config.max_spool_size = 64u * 1024u * 1024u;
+    config.shutdown_timeout = std::chrono::milliseconds(0);
+    StreamSpool spool("127.0.0.1", ntohs(address.sin_port), config);
+    int collector = ::accept(listener, nullptr, nullptr);
+    ASSERT_GE(collector, 0);
+
+    // Fill the socket until a batch frame is sent partially.
+    const std::string record(1024u, 'x');
+    for (size_t i = 0u; i < 4096u; ++i)
+    {
+        spool.push(9u, record);
+    }
+    spool.flush();
+    ASSERT_TRUE(spool.isConnected());
+    ASSERT_GT(spool.pendingBytes(), 0u);
+    EXPECT_EQ(spool.getDroppedRecords(), 0u);
+
+    // Reset the connection: the rest of the frame is discarded.
+    linger reset{ 1, 0 };
+    ::setsockopt(collector, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+    ::close(collector);
+    for (size_t i = 0u; (i < 100u) && spool.isConnected(); ++i)
+    {
+        spool.flush();
+        ::usleep(1000);
+    }
+    ASSERT_FALSE(spool.isConnected());
+    EXPECT_GT(spool.getDroppedRecords(), 0u);
+    ::close(listener);
+}
@@ -0,0 +1,107 @@
+#include "MyLogger/Strategies/TraceSampler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+TEST(HeadSampler, RatioBounds)
+{
+    HeadSampler none(0.0);
+    HeadSampler all(1.0);
+    EXPECT_FALSE(none.shouldSample("00000000000000000000000000000000"));
+    EXPECT_FALSE(none.shouldSample("ffffffffffffffffffffffffffffffff"));
+    EXPECT_TRUE(all.shouldSample("00000000000000000000000000000000"));
+    EXPECT_TRUE(all.shouldSample("ffffffffffffffffffffffffffffffff"));
+}
+
+//-----------------------------------------------------------------------------
+TEST(HeadSampler, DecisionFollowsTraceIdLowBits)
+{
+    HeadSampler half(0.5);
+    EXPECT_DOUBLE_EQ(half.getRatio(), 0.5);
+    EXPECT_TRUE(half.shouldSample("ffffffffffffffff7fffffffffffffff"));
+    EXPECT_FALSE(half.shouldSample("00000000000000008000000000000000"));
+
+    // Copies decide the same way.
+    HeadSampler copy(half);
+    EXPECT_DOUBLE_EQ(copy.getRatio(), 0.5);
+    EXPECT_FALSE(copy.shouldSample("00000000000000008000000000000000"));
+}
+
+//-----------------------------------------------------------------------------
+TEST(HeadSampler, DecisionIsStoredOnTheTrace)
+{
+    HeadSampler none(0.0);
+    Trace trace("request");
+    EXPECT_FALSE(none.sample(trace));
+    EXPECT_FALSE(trace.isSampled());
+    auto child = trace.createChildSpan("child");
+    EXPECT_FALSE(child->isSampled());
+}
+
+//-----------------------------------------------------------------------------
+TEST(HeadSampler, RatioChangesWhileSampling)
+{
+    HeadSampler sampler(1.0);
+    std::atomic<bool> stop{ false };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back(
+            [&sampler, &stop]()
+            {
+                while (!stop.load())
+                {
+                    Trace trace("request");
+                    sampler.sample(trace);
+                }
+            });
+    }
+    for (int i = 0; i < 1000; ++i)
+    {
+        sampler = HeadSampler((i % 2 == 0) ? 0.0 : 1.0);
+    }
+    stop = true;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    Trace trace("request");
+    EXPECT_TRUE(sampler.sample(trace));
+}
+
+//-----------------------------------------------------------------------------
+TEST(HeadSampler, UndecidedTracesAreDecidedFromTheirTraceId)
+{
+    HeadSampler none(0.0);
+    Trace trace("request");
+    auto child = trace.createChildSpan("child");
+    EXPECT_FALSE(child->isSamplingDecided());
+    EXPECT_TRUE(child->isSampled());
+    EXPECT_FALSE(none.isSampled(*child));
+    EXPECT_TRUE(HeadSampler(1.0).isSampled(*child));
+
+    none.sample(trace);
+    EXPECT_TRUE(trace.isSamplingDecided());
+    EXPECT_TRUE(trace.createChildSpan("late")->isSamplingDecided());
+}
+
+//-----------------------------------------------------------------------------
+TEST(HeadSampler, ChildSpansShareTheTraceId)
+{
+    Trace trace("request");
+    auto child = trace.createChildSpan("child");
+    auto grandchild = child->createChildSpan("grandchild");
+
+    EXPECT_EQ(child->getTraceId(), trace.getTraceId());
+    EXPECT_EQ(grandchild->getTraceId(), trace.getTraceId());
+    EXPECT_TRUE(trace.getParentSpanId().empty());
+    EXPECT_EQ(child->getParentSpanId(), trace.getSpanId());
+    EXPECT_EQ(grandchild->getParentSpanId(), child->getSpanId());
+    EXPECT_EQ(trace.getChildren().size(), 1u);
+    EXPECT_EQ(child->getChildren().size(), 1u);
+}
@@ -0,0 +1,56 @@
+#include "MyLogger/Strategies/Formatters/Binary/BinaryLogConverter.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+// *****************************************************************************
+//! \brief Convert a binary log written by BinaryFileFormatter into the JSON
+//! document written by OpenTelemetryFileFormatter.
+//!
+//! Usage: mylogger-bin2json <input.mlb> [output.json]
+//!   The JSON is written on the standard output when no output is given.
+// *****************************************************************************
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input.mlb> [output.json]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input)
+    {
+        std::cerr << "Error: cannot open " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::string data((std::istreambuf_iterator<char>(input)),
+                           std::istreambuf_iterator<char>());
+
+    std::string json;
+    std::string error = BinaryLogConverter::toJson(data.data(), data.size(),
+                                                   json);
+    if (!error.empty())
+    {
+        std::cerr << argv[1] << ": " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (argc < 3)
+    {
+        std::cout << json;
+        return EXIT_SUCCESS;
+    }
+
+    std::ofstream output(argv[2], std::ios::binary);
+    if (!(output << json))
+    {
+        std::cerr << "Error: cannot write " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
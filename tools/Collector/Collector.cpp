@@ -0,0 +1,85 @@
+#include "MyLogger/Strategies/Writers/FrameProtocol.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// *****************************************************************************
+//! \brief Minimal collector decoding the frames sent by SocketLogWriter.
+//! Each record is printed on its own line prefixed by its severity number.
+//! Connections are served one after the other.
+//!
+//! Usage: mylogger-collector [port]
+//!   port: TCP port to listen on (default 9999), bound to the loopback.
+// *****************************************************************************
+int main(int argc, char* argv[])
+{
+    const auto port =
+        static_cast<uint16_t>(argc > 1 ? std::atoi(argv[1]) : 9999);
+
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        std::cerr << "socket: " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if ((::bind(listener,
+                reinterpret_cast<sockaddr*>(&address),
+                sizeof(address)) < 0) ||
+        (::listen(listener, 1) < 0))
+    {
+        std::cerr << "bind/listen: " << std::strerror(errno) << std::endl;
+        ::close(listener);
+        return EXIT_FAILURE;
+    }
+    std::cerr << "Listening on 127.0.0.1:" << port << std::endl;
+
+    char buffer[64 * 1024];
+    for (;;)
+    {
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0)
+        {
+            continue;
+        }
+        std::cerr << "Client connected" << std::endl;
+
+        FrameDecoder decoder;
+        ssize_t received;
+        while ((received = ::recv(client, buffer, sizeof(buffer), 0)) > 0)
+        {
+            bool valid = decoder.feed(
+                buffer,
+                static_cast<size_t>(received),
+                [](uint8_t p_severity, const char* p_data, size_t p_size)
+                {
+                    std::cout << '[' << int(p_severity) << "] ";
+                    std::cout.write(p_data, static_cast<std::streamsize>(p_size));
+                    std::cout << '\n';
+                });
+            if (!valid)
+            {
+                std::cerr << "Corrupted stream, closing" << std::endl;
+                break;
+            }
+        }
+        std::cout.flush();
+        ::close(client);
+        std::cerr << "Client disconnected" << std::endl;
+    }
+}
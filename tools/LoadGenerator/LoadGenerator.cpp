@@ -0,0 +1,423 @@
+#include "MyLogger/MyLogger.hpp"
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryFileFormatter.hpp"
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryLineFormatter.hpp"
+#include "MyLogger/Strategies/Formatters/OpenTelemetry/OpenTelemetryNdjsonFileFormatter.hpp"
+#include "MyLogger/Strategies/LatencyHistogram.hpp"
+#include "MyLogger/Strategies/Writers/FileLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/GzipFileLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/SocketLogWriter.hpp"
+#include "MyLogger/Strategies/Writers/UdpLogWriter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using LineFormatter = OpenTelemetryLineFormatter;
+
+// *****************************************************************************
+//! \brief Settings of a load run, given on the command line.
+// *****************************************************************************
+struct LoadConfig
+{
+    //! \brief Number of logging threads
+    size_t threads = 4u;
+    //! \brief Records per second for all threads (0: as fast as possible)
+    double rate = 0.0;
+    //! \brief Duration of the run in seconds
+    double duration = 10.0;
+    //! \brief Writer: file, ndjson, gzip, socket or udp
+    std::string writer = "file";
+    //! \brief Log file of the file writers
+    std::string output = "mylogger-load.log";
+    //! \brief Collector of the network writers
+    std::string host = "127.0.0.1";
+    //! \brief Port of the collector
+    unsigned short port = 9999;
+};
+
+// *****************************************************************************
+//! \brief Results shared by the logging threads.
+// *****************************************************************************
+struct LoadResults
+{
+    //! \brief Duration of the Logger::log() calls, in nanoseconds
+    LatencyHistogram call_latency;
+    //! \brief Time from the scheduled start of a record to the return of
+    //! Logger::log(), in nanoseconds. Unlike call_latency, it includes the
+    //! delay accumulated behind slow calls (coordinated omission).
+    LatencyHistogram scheduled_latency;
+    //! \brief Number of logged records
+    std::atomic<uint64_t> records{ 0u };
+    //! \brief Number of bytes of the logged records
+    std::atomic<uint64_t> bytes{ 0u };
+};
+
+// *****************************************************************************
+//! \brief End-to-end load generator: N threads log traces shaped like the
+//! ones of doc/demo through a Logger at a target rate, the latency of each
+//! call is recorded into HDR histograms and the sustained records/s and
+//! bytes/s are reported, to size the hosts running the logger.
+// *****************************************************************************
+class LoadGenerator
+{
+public:
+
+    //-------------------------------------------------------------------------
+    //! \brief Build the trace of a payment request (see doc/demo).
+    //! \param p_thread Index of the logging thread.
+    //! \param p_sequence Index of the record in the thread.
+    //-------------------------------------------------------------------------
+    static Trace makeTrace(size_t p_thread, uint64_t p_sequence)
+    {
+        Trace trace("payment_processing",
+                    { { "amount", "99.99" }, { "currency", "EUR" } });
+        trace.addAttribute("thread", std::to_string(p_thread));
+        trace.addAttribute("transaction_id", std::to_string(p_sequence));
+
+        auto validation = trace.createChildSpan(
+            "payment_validation",
+            { { "card_type", "visa" }, { "validation_method", "3ds" } });
+        validation->addAttribute("card_last_four", "1234");
+        validation->addEvent("card_validated");
+        validation->end();
+
+        auto processing = trace.createChildSpan(
+            "payment_processing",
+            { { "gateway", "stripe" }, { "processor_id", "proc_789" } });
+        auto fraud = processing->createChildSpan("fraud_check",
+                                                 { { "score", "0.12" } });
+        fraud->end();
+        processing->addEvent("payment_sent_to_gateway");
+        processing->addEvent("payment_confirmed");
+        processing->end();
+
+        trace.end();
+        return trace;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Run the load through a logger and fill the results.
+    //-------------------------------------------------------------------------
+    template <typename LoggerType>
+    static void run(LoggerType& p_logger,
+                    const LoadConfig& p_config,
+                    LoadResults& p_results)
+    {
+        std::vector<std::thread> threads;
+        const auto start = Clock::now();
+        const auto stop =
+            start + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(p_config.duration));
+
+        for (size_t i = 0u; i < p_config.threads; ++i)
+        {
+            threads.emplace_back(
+                [&, i]()
+                { logLoop(p_logger, p_config, i, start, stop, p_results); });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        p_logger.flush();
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Print the throughput and the latency percentiles.
+    //! \param p_elapsed Duration of the run, flush included.
+    //-------------------------------------------------------------------------
+    static void report(const LoadConfig& p_config,
+                       const LoadResults& p_results,
+                       std::chrono::duration<double> p_elapsed)
+    {
+        const double seconds = p_elapsed.count();
+        const auto records = static_cast<double>(p_results.records.load());
+        const auto bytes = static_cast<double>(p_results.bytes.load());
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "writer:      " << p_config.writer << '\n'
+                  << "threads:     " << p_config.threads << '\n'
+                  << "target:      " << p_config.rate << " records/s\n"
+                  << "duration:    " << seconds << " s\n"
+                  << "records:     " << p_results.records.load() << '\n'
+                  << "throughput:  " << records / seconds << " records/s, "
+                  << bytes / seconds / (1024.0 * 1024.0) << " MiB/s\n";
+        printLatency("log() call", p_results.call_latency);
+        if (p_config.rate > 0.0)
+        {
+            printLatency("scheduled", p_results.scheduled_latency);
+        }
+    }
+
+private:
+
+    //-------------------------------------------------------------------------
+    //! \brief Body of a logging thread: log one trace per period (or back to
+    //! back without target rate) until the end of the run.
+    //-------------------------------------------------------------------------
+    template <typename LoggerType>
+    static void logLoop(LoggerType& p_logger,
+                        const LoadConfig& p_config,
+                        size_t p_thread,
+                        Clock::time_point p_start,
+                        Clock::time_point p_stop,
+                        LoadResults& p_results)
+    {
+        // Same settings as the logger's formatter, to measure record sizes.
+        LineFormatter sizer("load-generator", "1.0");
+        const bool paced = p_config.rate > 0.0;
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(
+                paced ? static_cast<double>(p_config.threads) / p_config.rate
+                      : 0.0));
+
+        // Threads are shifted within the period to avoid synchronized bursts.
+        auto scheduled = p_start + period * static_cast<long>(p_thread) /
+                                       static_cast<long>(p_config.threads);
+        uint64_t records = 0u;
+        uint64_t bytes = 0u;
+        uint64_t record_size = 0u;
+        while (scheduled < p_stop)
+        {
+            Trace trace = makeTrace(p_thread, records);
+            if (record_size == 0u)
+            {
+                record_size = sizer.formatBegin(LogLevel::INFO).size() +
+                              sizer.formatMiddle(trace).size() +
+                              sizer.formatEnd().size();
+            }
+
+            if (paced)
+            {
+                std::this_thread::sleep_until(scheduled);
+            }
+            const auto before = Clock::now();
+            p_logger.log(LogLevel::INFO, trace);
+            const auto after = Clock::now();
+
+            p_results.call_latency.record(nanoseconds(after - before));
+            if (paced)
+            {
+                p_results.scheduled_latency.record(
+                    nanoseconds(after - scheduled));
+                scheduled += period;
+            }
+            else
+            {
+                scheduled = after;
+            }
+            ++records;
+            bytes += record_size;
+        }
+        p_results.records += records;
+        p_results.bytes += bytes;
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Convert a duration into nanoseconds.
+    //-------------------------------------------------------------------------
+    static uint64_t nanoseconds(Clock::duration p_duration)
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(p_duration)
+                .count());
+    }
+
+    //-------------------------------------------------------------------------
+    //! \brief Print the percentiles of a histogram in microseconds.
+    //-------------------------------------------------------------------------
+    static void printLatency(const char* p_name,
+                             const LatencyHistogram& p_histogram)
+    {
+        static const std::pair<const char*, double> percentiles[] = {
+            { "p50", 50.0 },
+            { "p90", 90.0 },
+            { "p99", 99.0 },
+            { "p99.9", 99.9 },
+            { "p99.99", 99.99 }
+        };
+
+        std::cout << "latency (" << p_name << ", us):" << std::setprecision(2)
+                  << " mean " << p_histogram.mean() / 1000.0;
+        for (const auto& [label, percentile] : percentiles)
+        {
+            std::cout << ", " << label << ' '
+                      << static_cast<double>(
+                             p_histogram.percentile(percentile)) /
+                             1000.0;
+        }
+        std::cout << ", max "
+                  << static_cast<double>(p_histogram.max()) / 1000.0
+                  << std::endl;
+    }
+};
+
+//-----------------------------------------------------------------------------
+//! \brief Build the logger of the chosen writer and run the load.
+//! \param p_make_writer Callable building the writer from the formatters.
+//-----------------------------------------------------------------------------
+template <typename WriterType, typename FileFormatterType, typename Factory>
+static void runWith(const LoadConfig& p_config,
+                    LoadResults& p_results,
+                    Factory p_make_writer)
+{
+    auto line_formatter =
+        std::make_unique<LineFormatter>("load-generator", "1.0");
+    auto file_formatter = std::make_unique<FileFormatterType>(
+        *line_formatter, p_config.output, FileMode::Create);
+    std::unique_ptr<WriterType> writer =
+        p_make_writer(*line_formatter, *file_formatter);
+
+    Logger<WriterType, FileFormatterType, LineFormatter> logger(
+        std::move(writer),
+        std::move(line_formatter),
+        std::move(file_formatter));
+    LoadGenerator::run(logger, p_config, p_results);
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Parse the command line.
+//! \return false on unknown option.
+//-----------------------------------------------------------------------------
+static bool parseArguments(int argc, char* argv[], LoadConfig& p_config)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument(argv[i]);
+        const size_t equal = argument.find('=');
+        const std::string name = argument.substr(0u, equal);
+        const std::string value =
+            (equal == std::string::npos) ? "" : argument.substr(equal + 1u);
+
+        if (name == "--threads")
+        {
+            p_config.threads =
+                std::max<size_t>(1u, std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (name == "--rate")
+        {
+            p_config.rate = std::atof(value.c_str());
+        }
+        else if (name == "--duration")
+        {
+            p_config.duration = std::atof(value.c_str());
+        }
+        else if (name == "--writer")
+        {
+            p_config.writer = value;
+        }
+        else if (name == "--output")
+        {
+            p_config.output = value;
+        }
+        else if (name == "--host")
+        {
+            p_config.host = value;
+        }
+        else if (name == "--port")
+        {
+            p_config.port =
+                static_cast<unsigned short>(std::atoi(value.c_str()));
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// *****************************************************************************
+//! \brief Load generator of MyLogger.
+//!
+//! Usage: mylogger-loadgen [--threads=4] [--rate=0] [--duration=10]
+//!                         [--writer=file|ndjson|gzip|socket|udp]
+//!                         [--output=mylogger-load.log]
+//!                         [--host=127.0.0.1] [--port=9999]
+//!   --rate: records per second for all threads, 0 logs as fast as possible.
+//!   The socket writer needs a collector (i.e. mylogger-collector).
+// *****************************************************************************
+int main(int argc, char* argv[])
+{
+    LoadConfig config;
+    if (!parseArguments(argc, argv, config))
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--threads=N] [--rate=records/s] [--duration=s]"
+                     " [--writer=file|ndjson|gzip|socket|udp]"
+                     " [--output=file] [--host=address] [--port=port]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    using OtelFormatter = OpenTelemetryFileFormatter;
+    using NdjsonFormatter = OpenTelemetryNdjsonFileFormatter;
+    LoadResults results;
+    const auto start = Clock::now();
+
+    if (config.writer == "file")
+    {
+        runWith<FileLogWriter<LineFormatter>, OtelFormatter>(
+            config,
+            results,
+            [](LineFormatter&, OtelFormatter& p_file)
+            { return std::make_unique<FileLogWriter<LineFormatter>>(p_file); });
+    }
+    else if (config.writer == "ndjson")
+    {
+        runWith<FileLogWriter<LineFormatter>, NdjsonFormatter>(
+            config,
+            results,
+            [](LineFormatter&, NdjsonFormatter& p_file)
+            { return std::make_unique<FileLogWriter<LineFormatter>>(p_file); });
+    }
+    else if (config.writer == "gzip")
+    {
+        runWith<GzipFileLogWriter<LineFormatter>, OtelFormatter>(
+            config,
+            results,
+            [](LineFormatter&, OtelFormatter& p_file) {
+                return std::make_unique<GzipFileLogWriter<LineFormatter>>(
+                    p_file);
+            });
+    }
+    else if (config.writer == "socket")
+    {
+        runWith<SocketLogWriter<LineFormatter>, OtelFormatter>(
+            config,
+            results,
+            [&config](LineFormatter& p_line, OtelFormatter&)
+            {
+                return std::make_unique<SocketLogWriter<LineFormatter>>(
+                    config.host, config.port, p_line);
+            });
+    }
+    else if (config.writer == "udp")
+    {
+        runWith<UdpLogWriter<LineFormatter>, OtelFormatter>(
+            config,
+            results,
+            [&config](LineFormatter& p_line, OtelFormatter&)
+            {
+                return std::make_unique<UdpLogWriter<LineFormatter>>(
+                    config.host, config.port, p_line);
+            });
+    }
+    else
+    {
+        std::cerr << "Unknown writer: " << config.writer << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    LoadGenerator::report(config, results, Clock::now() - start);
+    return EXIT_SUCCESS;
+}